@@ -83,7 +83,7 @@ int main() try
     }
     fmt::print("group built: {}\n", time_passed(start));
     start = std::chrono::steady_clock::now();
-    group.render_on(image);
+    group.render_on(image, n_threads);
     fmt::print("Image rendered: {}\n", time_passed(start));
     start = std::chrono::steady_clock::now();
 
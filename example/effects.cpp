@@ -39,6 +39,24 @@ auto box_blur(auto const & image)
     image_blurred.save_to_file(result_name);
 }
 
+auto gaussian_blur(auto const & image)
+{
+    constexpr auto result_name = "example_effects_gaussian_blur.png";
+    fmt::print("Gaussian blur ({})...\n", result_name);
+    auto image_blurred = spl::graphics::blur(spl::graphics::effects::gaussian{6.}, image, 0);
+    image_blurred.save_to_file(result_name);
+}
+
+auto kawase_blur_and_bloom(auto const & image)
+{
+    constexpr auto blur_name  = "example_effects_kawase_blur.png";
+    constexpr auto bloom_name = "example_effects_bloom.png";
+    fmt::print("Kawase blur ({}) and bloom ({})...\n", blur_name, bloom_name);
+    spl::graphics::blur(spl::graphics::effects::kawase{4}, image, 0).save_to_file(blur_name);
+    spl::graphics::bloom(spl::graphics::effects::bloom{.threshold = 200, .intensity = 1.5f}, image, 0)
+        .save_to_file(bloom_name);
+}
+
 auto blur_quadrants(auto image)
 {
     constexpr auto result_name = "example_effects_blur_quadrants.png";
@@ -84,6 +102,8 @@ int main(int argc, char * argv[])
 
         triangular_blur(image);
         box_blur(image);
+        gaussian_blur(image);
+        kawase_blur_and_bloom(image);
         blur_quadrants(image);
 
         // spl::graphics::blur(std::in_place, spl::effects_::kawase{.radius=2, .boh={0, 1, 2, 2, 3}}, image);
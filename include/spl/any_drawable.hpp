@@ -9,8 +9,10 @@
 #define ANY_DRAWABLE_HPP
 
 #include <memory>
+#include <optional>
 #include "spl/drawable.hpp"
 #include "spl/viewport.hpp"
+#include "spl/primitives/bounding_box.hpp"
 
 namespace spl::graphics
 {
@@ -38,11 +40,29 @@ struct any_drawable
         }
     }
 
+    /// The area touched by the contained object, if it provides one
+    auto bounding_box() const -> std::optional<graphics::bounding_box>
+    {
+        if (_self) {
+            return _self->bounding_box();
+        }
+        return graphics::bounding_box{};
+    }
+
+    /// A pointer to the contained object if it is a `T`, `nullptr` otherwise
+    template <drawable T>
+    auto target() const noexcept -> T const *
+    {
+        auto const ptr = dynamic_cast<model<T> const *>(_self.get());
+        return ptr ? std::addressof(ptr->_data) : nullptr;
+    }
+
 private:
     struct concept_t
     {
         virtual ~concept_t() noexcept = default;
         virtual void render_on(graphics::viewport) const = 0;
+        virtual auto bounding_box() const -> std::optional<graphics::bounding_box> = 0;
     };
 
     template <drawable T>
@@ -57,6 +77,14 @@ private:
                 _data(img);
             }
         }
+        auto bounding_box() const -> std::optional<graphics::bounding_box> final
+        {
+            if constexpr (spl::detail::has_bounding_box<T>) {
+                return _data.bounding_box();
+            } else {
+                return std::nullopt;
+            }
+        }
         T _data;
     };
 
@@ -0,0 +1,124 @@
+/**
+ * @author      : rbrugo, momokrono
+ * @file        : glyph_cache
+ * @created     : Monday Oct 19, 2026 11:05:38 CEST
+ * @license     : MIT
+ * */
+
+#ifndef DETAIL_GLYPH_CACHE_HPP
+#define DETAIL_GLYPH_CACHE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <vector>
+
+namespace spl::detail
+{
+
+/// A rasterized glyph: `width` ⨉ `height` coverage values, `stride` bytes apart between rows, to
+/// be drawn `x_off`, `y_off` pixels away from the pen position
+struct glyph_bitmap
+{
+    uint8_t const * data = nullptr;
+    int width  = 0;
+    int height = 0;
+    int stride = 0;
+    int x_off  = 0;
+    int y_off  = 0;
+};
+
+/// What tells apart the glyphs of the same face
+struct glyph_key
+{
+    int32_t codepoint;
+    uint32_t height_bits; ///< the pixel height, as the bits of its `float`
+    uint8_t shift;        ///< the horizontal subpixel offset, in `glyph_cache::subpixel_steps`,
+                          ///< or `glyph_cache::distance_field` for a signed distance field
+
+    constexpr bool operator==(glyph_key const &) const noexcept = default;
+};
+
+/// The glyphs already rasterized from a face, shared by every thread drawing with it
+///
+/// The bitmaps are packed in a few square pages, on shelves of similar height; the lookup goes
+/// through a flat, linearly probed table. When every page is full, the one used least recently
+/// is emptied, along with all of its glyphs. Lookups share the lock, insertions take it alone.
+class glyph_cache
+{
+public:
+    static constexpr int page_size      = 512;
+    static constexpr int subpixel_steps = 4;
+    static constexpr uint8_t distance_field = 0xff;
+
+    /// A cached glyph: the cache can not drop it, nor grow, until this is destroyed
+    struct handle
+    {
+        std::shared_lock<std::shared_mutex> lock;
+        glyph_bitmap bitmap;
+    };
+
+    explicit glyph_cache(std::size_t max_pages = 8) : _max_pages{max_pages} {}
+
+    glyph_cache(glyph_cache const &) = delete;
+    auto operator=(glyph_cache const &) -> glyph_cache & = delete;
+
+    /// The glyph stored with `key`, if any
+    auto find(glyph_key key) const
+        -> std::optional<handle>;
+
+    /// Stores a copy of `bitmap` with `key`; glyphs larger than a page are not stored
+    void insert(glyph_key key, glyph_bitmap bitmap);
+
+    void clear();
+
+private:
+    struct shelf
+    {
+        int y;
+        int height;
+        int x;
+    };
+
+    struct page
+    {
+        std::unique_ptr<uint8_t[]> pixels = std::make_unique<uint8_t[]>(page_size * page_size);
+        std::vector<shelf> shelves;
+        int next_y = 0;
+        std::size_t glyphs = 0;
+        mutable std::atomic<uint64_t> last_use = 0;
+    };
+
+    struct entry
+    {
+        glyph_key key = {-1, 0, 0};
+        uint16_t page = 0;
+        uint16_t x = 0;
+        uint16_t y = 0;
+        int16_t width  = 0;
+        int16_t height = 0;
+        int16_t x_off  = 0;
+        int16_t y_off  = 0;
+    };
+
+    mutable std::shared_mutex _mutex;
+    mutable std::atomic<uint64_t> _clock = 0;
+    std::vector<std::unique_ptr<page>> _pages;
+    std::vector<entry> _table;
+    std::size_t _entries = 0;
+    std::size_t _max_pages;
+
+    auto _slot(glyph_key key) const noexcept -> std::size_t;
+    void _place(entry const & e);
+    void _rehash(std::size_t capacity);
+    auto _allocate(int width, int height) -> std::optional<entry>;
+    void _evict(std::size_t page_index);
+};
+
+} // namespace spl::detail
+
+#endif /* DETAIL_GLYPH_CACHE_HPP */
@@ -2,6 +2,7 @@
 #define ITERATORS_HPP
 
 #include <compare>
+#include <memory_resource>
 #include <vector>
 #include <ranges>
 
@@ -31,13 +32,17 @@ struct iter_step<false>
 };
 } // namespace detail
 
+template <bool is_row, bool is_const>
+class row_col_range;
+
 template <bool is_row, bool is_const>
 class row_col_iter : detail::iter_step<is_row>
 {
     using base = detail::iter_step<is_row>;
 public:
     friend class row_col_iter<is_row, true>;
-    using iterator          = std::conditional_t<is_const, std::vector<rgba>::const_iterator, std::vector<rgba>::iterator>;
+    friend class row_col_range<is_row, is_const>;
+    using iterator          = std::conditional_t<is_const, std::pmr::vector<rgba>::const_iterator, std::pmr::vector<rgba>::iterator>;
     using iterator_category = iterator::iterator_category;
     using difference_type   = iterator::difference_type;
     using value_type        = iterator::value_type;
@@ -86,9 +91,9 @@ public:
         -> row_col_iter&
     {
         if constexpr (is_row) {
-            _it += n;
+            _it -= n;
         } else {
-            _it += n * base::step;
+            _it -= n * base::step;
         }
         return *this;
     }
@@ -208,16 +213,21 @@ public:
 private:
     iterator _begin;
     size_t _length = 0;
+    difference_type _next = is_row ? 0 : 1;   // the pixels between this row (or column) and the next
 
 public:
     row_col_range() noexcept = default;
     row_col_range(row_col_range const &) noexcept = default;
     row_col_range(row_col_range      &&) noexcept = default;
 
-    row_col_range(iterator const b, size_t const c) noexcept : _begin{b}, _length{c} {}
+    row_col_range(iterator const b, size_t const c) noexcept
+        : row_col_range{b, c, is_row ? static_cast<difference_type>(c) : 1} {}
+    /// The next row (or column) starts `next` pixels after this one, e.g. the stride for rows
+    row_col_range(iterator const b, size_t const c, difference_type const next) noexcept
+        : _begin{b}, _length{c}, _next{next} {}
 
     row_col_range(row_col_range<is_row, false> const & other) requires is_const :
-        _begin{other._begin}, _length{other._length} {}
+        _begin{other._begin}, _length{other._length}, _next{other._next} {}
 
     auto operator=(row_col_range const &) noexcept -> row_col_range & = default;
     auto operator=(row_col_range      &&) noexcept -> row_col_range & = default;
@@ -228,6 +238,7 @@ public:
     {
         _begin = other._begin;
         _length = other._length;
+        _next = other._next;
         return *this;
     }
 
@@ -262,11 +273,7 @@ public:
     auto operator+=(size_t const n) noexcept
         -> row_col_range &
     {
-        if constexpr (is_row) {
-            _begin += _length * n;
-        } else {
-            _begin += n;
-        }
+        _begin._it += static_cast<difference_type>(n) * _next;
         return *this;
     }
     auto operator+(size_t const n) const noexcept { auto copy = *this; return copy += n; }
@@ -0,0 +1,56 @@
+/**
+ * @author      : rbrugo, momokrono
+ * @file        : mapped_file
+ * @created     : Saturday Oct 17, 2026 21:40:12 CEST
+ * @license     : MIT
+ * */
+
+#ifndef DETAIL_MAPPED_FILE_HPP
+#define DETAIL_MAPPED_FILE_HPP
+
+#include <cstddef>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace spl::detail
+{
+
+/// A file mapped in memory for reading
+///
+/// Where `mmap` is not available the file is read in a buffer instead.
+class mapped_file
+{
+public:
+    /// How a mapped file will be read, so that the system can read ahead or not
+    enum class access_pattern
+    {
+        sequential, ///< from the beginning to the end, like a decoder does
+        random,     ///< jumping around, like the lookups in the tables of a font
+    };
+
+    /// Maps an existing file for reading; empty if it cannot be opened
+    static auto open(std::filesystem::path const & filename, access_pattern access = access_pattern::sequential)
+        -> std::optional<mapped_file>;
+
+    mapped_file(mapped_file && other) noexcept;
+    auto operator=(mapped_file && other) noexcept -> mapped_file &;
+    ~mapped_file() noexcept;
+
+    auto bytes() const noexcept -> std::span<std::byte const> { return {_data, _size}; }
+    auto size()  const noexcept { return _size; }
+
+    void close() noexcept;
+
+private:
+    mapped_file() = default;
+
+    std::byte * _data = nullptr;
+    std::size_t _size = 0;
+    std::vector<std::byte> _fallback;
+};
+
+} // namespace spl::detail
+
+#endif /* DETAIL_MAPPED_FILE_HPP */
@@ -0,0 +1,30 @@
+/**
+ * @author      : rbrugo, momokrono
+ * @file        : png
+ * @created     : Saturday Oct 17, 2026 23:05:41 CEST
+ * @license     : MIT
+ * */
+
+#ifndef DETAIL_PNG_HPP
+#define DETAIL_PNG_HPP
+
+#include <cstddef>
+#include <vector>
+
+#include "spl/viewport.hpp"
+
+namespace spl::detail
+{
+
+/// Encodes `v` as an RGBA PNG, handing it to `write` a chunk at a time; false if the image is
+/// empty or the compression fails, possibly after some chunks were written
+///
+/// The rows are filtered and compressed in strips of fixed size, each one primed with the end of
+/// the previous strip and flushed to a byte boundary, so that the deflate streams of the strips
+/// can be concatenated. A batch of strips is processed in parallel and written before the next
+/// one, so that only the batch is kept in memory. The result does not depend on the threads.
+auto encode_png(graphics::image_view v, graphics::save_options const & options, graphics::byte_sink const & write) -> bool;
+
+} // namespace spl::detail
+
+#endif /* DETAIL_PNG_HPP */
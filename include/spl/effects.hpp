@@ -24,25 +24,34 @@ namespace effects {
     // struct grayscale {};
     struct triangular { int_fast32_t radius;};
     struct box { int_fast32_t radius; };
-    // struct gaussian { ... };
-    // struct kawase { int_fast32_t radius; std::vector<int> boh; };
+    /// Approximated with three box passes, whose cost does not depend on `sigma`; coarse for
+    /// `sigma` below 2
+    struct gaussian { double sigma; };
+    /// Dual filter blur: the image is halved `iterations` times and scaled back, sampling around
+    /// each pixel `offset` pixels apart; every iteration roughly doubles the radius
+    struct kawase { int_fast32_t iterations; float offset = 1.f; };
+    /// Adds a kawase blurred copy of the pixels brighter than `threshold` to the image
+    struct bloom { uint8_t threshold; int_fast32_t iterations = 4; float intensity = 1.f; };
     // struct bokeh { ... };
 }
 
 template <typename Effect>
 concept blur_policy = std::same_as<Effect, effects::triangular>
-                   or std::same_as<Effect, effects::box>;
+                   or std::same_as<Effect, effects::box>
+                   or std::same_as<Effect, effects::gaussian>
+                   or std::same_as<Effect, effects::kawase>;
 
 inline
 void greyscale(std::in_place_t, spl::graphics::viewport v)
 {
+    v.add_damage({0, 0, v.swidth(), v.sheight()});
     std::ranges::transform(v, v.begin(), &spl::graphics::grayscale);
 }
 
 [[nodiscard]] inline
 spl::graphics::image greyscale(spl::graphics::image_view v)
 {
-    auto img = spl::graphics::image{v};
+    auto img = spl::graphics::image{v, v.base().get_allocator()};
     greyscale(std::in_place, img);
     return img;
 }
@@ -57,12 +66,14 @@ spl::graphics::image greyscale(image && img)
 
 void blur(std::in_place_t, effects::triangular, viewport original, int16_t threads = 1);
 void blur(std::in_place_t, effects::box, viewport original, int16_t threads = 1);
+void blur(std::in_place_t, effects::gaussian, viewport original, int16_t threads = 1);
+void blur(std::in_place_t, effects::kawase, viewport original, int16_t threads = 1);
 
 template <spl::graphics::blur_policy Effect>
 [[nodiscard]] inline
 spl::graphics::image blur(Effect effect, image_view v, uint16_t threads = 1)
 {
-    auto img = spl::graphics::image{v};
+    auto img = spl::graphics::image{v, v.base().get_allocator()};
     blur(std::in_place, effect, img, threads);
     return img;
 }
@@ -76,6 +87,24 @@ spl::graphics::image blur(Effect effect, spl::graphics::image && img, uint16_t t
     return res;
 }
 
+void bloom(std::in_place_t, effects::bloom, viewport original, int16_t threads = 1);
+
+[[nodiscard]] inline
+spl::graphics::image bloom(effects::bloom effect, image_view v, uint16_t threads = 1)
+{
+    auto img = spl::graphics::image{v, v.base().get_allocator()};
+    bloom(std::in_place, effect, img, threads);
+    return img;
+}
+
+[[nodiscard]] inline
+spl::graphics::image bloom(effects::bloom effect, spl::graphics::image && img, uint16_t threads = 1)
+{
+    auto res = std::move(img);
+    bloom(std::in_place, effect, res, threads);
+    return res;
+}
+
 } // namespace spl::graphics
 
 #endif /* EFFECTS_HPP */
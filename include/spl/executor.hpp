@@ -0,0 +1,92 @@
+/**
+ * @author      : rbrugo, momokrono
+ * @file        : executor
+ * @created     : Saturday Oct 17, 2026 17:02:48 CEST
+ * @license     : MIT
+ * */
+
+#ifndef EXECUTOR_HPP
+#define EXECUTOR_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace spl
+{
+
+/// Runs tasks concurrently; every parallel algorithm of the library submits its work to one
+class executor
+{
+public:
+    virtual ~executor() noexcept = default;
+
+    /// Schedules `task` to be run on some thread; it must not throw
+    virtual void submit(std::function<void()> task) = 0;
+    /// The number of tasks that can run at the same time
+    virtual auto concurrency() const noexcept -> std::size_t = 0;
+};
+
+/// An executor with a fixed number of threads
+///
+/// Every thread has its own queue: the tasks submitted from a thread of the pool go to its queue,
+/// the others are distributed round-robin. An idle thread steals from the others' queues.
+class thread_pool final : public executor
+{
+public:
+    /// Starts `threads` threads (at least one); by default, one for every core except the caller's
+    explicit thread_pool(std::size_t threads = std::max(std::thread::hardware_concurrency(), 2u) - 1);
+    /// Runs the tasks still queued, then joins the threads
+    ~thread_pool() noexcept override;
+
+    thread_pool(thread_pool const &) = delete;
+    thread_pool & operator=(thread_pool const &) = delete;
+
+    void submit(std::function<void()> task) override;
+    auto concurrency() const noexcept -> std::size_t override { return _workers.size(); }
+
+private:
+    struct queue
+    {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    void _run(std::stop_token stop, std::size_t index) noexcept;
+    auto _pop(std::size_t index) -> std::function<void()>;
+
+    std::vector<std::unique_ptr<queue>> _queues;
+    std::atomic<std::size_t> _next_queue{0};
+    std::atomic<std::size_t> _pending{0};
+    std::mutex _sleep_mutex;
+    std::condition_variable_any _wake;
+    std::vector<std::jthread> _workers;
+};
+
+/// The executor used by the library, a `thread_pool` created on first use unless replaced
+auto default_executor() -> executor &;
+
+/// Makes the library use `ex`, which must outlive its uses; `nullptr` restores the default pool
+void set_default_executor(executor * ex) noexcept;
+
+/// Calls `body(begin, end)` on consecutive chunks covering `[0, n)`, in parallel
+///
+/// At most `max_threads` chunks run at the same time (`0` means as many as the executor allows,
+/// plus the calling thread). The calling thread processes chunks too, so it is safe to call this
+/// from a task of the same executor. The first exception thrown by `body` is rethrown; a failure
+/// to submit a helper only leaves more chunks to the others.
+void parallel_for(
+    std::size_t n, std::function<void(std::size_t, std::size_t)> const & body,
+    std::size_t max_threads = 0, executor & ex = default_executor()
+);
+
+} // namespace spl
+
+#endif /* EXECUTOR_HPP */
@@ -8,6 +8,7 @@
 #ifndef RENDERER_HPP
 #define RENDERER_HPP
 
+#include <optional>
 #include <vector>
 
 #include "spl/any_drawable.hpp"
@@ -19,15 +20,35 @@ namespace spl::graphics
 
 class group
 {
+    struct flat_view;
+
     std::vector<any_drawable> _buffer;
     vertex _origin{0, 0};
 
+    void _flatten(flat_view & flat, size_t parent) const;
+
 public:
     template <typename ...Ts>
     group(Ts &&... args) {
         (push(args), ...);
     }
     void render_on(graphics::viewport img) const noexcept;
+    /// Renders the objects with the default executor, splitting the viewport in square tiles of side
+    /// `tile_size`
+    ///
+    /// Every tile draws, in order, the objects whose bounding box overlaps it, so the result is the
+    /// same of the serial rendering; the nested groups are expanded. The objects without a bounding
+    /// box are drawn alone, once the ones pushed before them are done. If `threads <= 0` all the
+    /// available threads are used.
+    void render_on(graphics::viewport img, int16_t threads, uint16_t tile_size = 128) const;
+    /// Renders again only `area`, in the coordinates of `img`, e.g. the damage of the image
+    ///
+    /// The objects whose bounding box does not overlap the area are skipped, the others are
+    /// clipped to it: the area must be cleared first, then it is drawn as in a full rendering.
+    /// `threads` and `tile_size` are the ones of the tiled rendering.
+    void render_on(graphics::viewport img, graphics::bounding_box area, int16_t threads = 1, uint16_t tile_size = 128) const;
+    /// The union of the bounding boxes of the objects, if all of them provide one
+    auto bounding_box() const -> std::optional<graphics::bounding_box>;
     template <drawable T>
     group & push(T obj) noexcept;
     void clear() noexcept { _buffer.clear(); }
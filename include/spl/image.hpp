@@ -1,11 +1,17 @@
 #ifndef IMAGE_HPP
 #define IMAGE_HPP
 
+#include <memory_resource>
 #include <vector>
 #include <cstdint>
 #include <filesystem>
+#include <functional>
+#include <iosfwd>
+#include <optional>
+#include <span>
 
 #include "spl/primitives/vertex.hpp"
+#include "spl/primitives/bounding_box.hpp"
 #include "spl/detail/iterators.hpp"
 #include "drawable.hpp"
 #include "rgba.hpp"
@@ -15,11 +21,44 @@ namespace spl::graphics
 
 enum class load_status : uint8_t { success, file_not_found, failure };
 
+/// The filter applied to each row of a PNG before compressing it
+enum class png_filter : uint8_t
+{
+    none, sub, up, average, paeth,
+    adaptive    ///< for each row, the filter giving the smallest sum of absolute differences
+};
+
+/// The formats an image can be encoded to
+enum class image_format : uint8_t { png, jpg, bmp, ppm, pam, spl };
+
+/// Receives the encoded bytes as they are produced, possibly in many calls; it must not throw,
+/// to give up it can ignore the following calls
+using byte_sink = std::function<void(std::span<std::byte const>)>;
+
+/// How `image::save_to_file` and `image::encode` encode the images
+struct save_options
+{
+    /// The deflate level of PNG, from 0 (stored) to 9 (smallest and slowest)
+    int8_t png_compression = 6;
+    png_filter filter = png_filter::adaptive;
+    /// From 1 to 100
+    int8_t jpeg_quality = 90;
+    /// The threads filtering and compressing a PNG; `<= 0` means all the available threads.
+    /// The file is the same whatever their number
+    int16_t threads = 1;
+};
+
 struct construct_uninitialized_t {};
 
 constexpr inline
 auto construct_uninitialized = construct_uninitialized_t{};
 
+struct aligned_rows_t {};
+
+/// Selects the layout with every row starting at a multiple of `image::row_alignment` bytes
+constexpr inline
+auto aligned_rows = aligned_rows_t{};
+
 template <bool Const>
 class basic_viewport;
 
@@ -27,13 +66,15 @@ class image
 {
     friend class basic_viewport<true>;
     friend class basic_viewport<false>;
-    static inline rgba _garbage_pixel;
+    // written by the primitives outside of the drawable area, possibly from different threads
+    static inline thread_local rgba _garbage_pixel;
 public:
     using value_type         = rgba;
     using reference          = value_type &;
     using const_reference    = value_type const &;
-    using iterator           = std::vector<value_type>::iterator;
-    using const_iterator     = std::vector<value_type>::const_iterator;
+    using allocator_type     = std::pmr::polymorphic_allocator<value_type>;
+    using iterator           = std::pmr::vector<value_type>::iterator;
+    using const_iterator     = std::pmr::vector<value_type>::const_iterator;
     using row_view           = spl::graphics::row_col_range<true, false>;
     using const_row_view     = spl::graphics::row_col_range<true, true>;
     using column_view        = spl::graphics::row_col_range<false, false>;
@@ -44,14 +85,34 @@ public:
     using const_column_range = spl::graphics::image_range<false, true>;
     using index_type         = std::size_t;
 
+    /// The alignment, in bytes, of the rows of the images constructed with `aligned_rows`
+    static constexpr index_type row_alignment = 64;
+
     // constructors
-    image() noexcept : _width{0}, _height{0} {};
-    image(index_type w, index_type h, rgba fill = {0, 0, 0, 255}) noexcept
-        : _pixels{w * h, fill}, _width{w}, _height{h} {}
-    image(construct_uninitialized_t, index_type w, index_type h) noexcept
-        : _pixels{w * h}, _width{w}, _height{h} {}
-    template <bool Const2> image(basic_viewport<Const2> v)
-        : _pixels(v.begin(), v.end()), _width{v.width()}, _height{v.height()} {}
+    // The pixels are allocated with `alloc`, so that images can live in arenas or pools: like
+    // for the standard containers, a copy uses the default resource unless given one
+    image() noexcept : _width{0}, _height{0}, _stride{0} {};
+    explicit image(allocator_type alloc) noexcept
+        : _pixels{alloc}, _width{0}, _height{0}, _stride{0} {}
+    image(index_type w, index_type h, rgba fill = {0, 0, 0, 255}, allocator_type alloc = {}) noexcept
+        : _pixels{w * h, fill, alloc}, _width{w}, _height{h}, _stride{w} {}
+    image(index_type w, index_type h, allocator_type alloc) noexcept
+        : image{w, h, {0, 0, 0, 255}, alloc} {}
+    image(construct_uninitialized_t, index_type w, index_type h, allocator_type alloc = {}) noexcept
+        : _pixels{w * h, alloc}, _width{w}, _height{h}, _stride{w} {}
+    /// The rows are padded to a multiple of `row_alignment` bytes and start at such an address,
+    /// so that they can be processed with aligned loads; the padding is filled with `fill` too
+    ///
+    /// The storage must be aligned to `sizeof(rgba)` at least, as the standard resources do
+    image(aligned_rows_t, index_type w, index_type h, rgba fill = {0, 0, 0, 255}, allocator_type alloc = {});
+    template <bool Const2> image(basic_viewport<Const2> v, allocator_type alloc = {})
+        : _pixels(v.begin(), v.end(), alloc), _width{v.width()}, _height{v.height()}, _stride{v.width()}, _blending{v.blending()} {}
+    image(image const & other, allocator_type alloc);
+    image(image const & other) : image{other, allocator_type{}} {}
+    // the storage is taken as it is, so are the offset of the first row and the alignment
+    image(image &&) noexcept = default;
+    auto operator=(image const & other) -> image &;
+    auto operator=(image && other) -> image &;
 
     // direct element access
     auto pixel(index_type const x, index_type const y)       -> reference;
@@ -64,6 +125,17 @@ public:
     auto pixel_noexcept(vertex const pt)       noexcept -> reference       { return pixel_noexcept(pt.x, pt.y); }
     auto pixel_noexcept(vertex const pt) const noexcept -> const_reference { return pixel_noexcept(pt.x, pt.y); }
 
+    /// Access without any check, for callers that already clipped the coordinates to the image
+    auto pixel_unchecked(index_type const x, index_type const y)       noexcept -> reference       { return row_ptr(y)[x]; }
+    auto pixel_unchecked(index_type const x, index_type const y) const noexcept -> const_reference { return row_ptr(y)[x]; }
+
+    /// The first pixel of the row `y`; the following rows are `stride()` pixels apart
+    auto row_ptr(index_type const y)       noexcept -> value_type *       { return _pixels.data() + _offset + y * _stride; }
+    auto row_ptr(index_type const y) const noexcept -> value_type const * { return _pixels.data() + _offset + y * _stride; }
+    /// The distance in pixels between the rows: the width, unless the rows are aligned
+    auto stride() const noexcept { return _stride; }
+    bool has_aligned_rows() const noexcept { return _aligned_rows; }
+
     // iteration
     auto row(index_type const y)            -> row_view;
     auto row(index_type const y) const      -> const_row_view;
@@ -77,12 +149,13 @@ public:
     auto columns()                      -> column_range;
     auto columns() const                -> const_column_range;
 
-    auto begin()        -> iterator       { return _pixels.begin(); }
-    auto begin()  const -> const_iterator { return _pixels.begin(); }
-    auto cbegin() const -> const_iterator { return _pixels.cbegin(); }
-    auto end()          -> iterator       { return _pixels.end(); }
-    auto end()    const -> const_iterator { return _pixels.end(); }
-    auto cend()   const -> const_iterator { return _pixels.cend(); }
+    // with aligned rows, the iteration visits the padding at the end of each row too
+    auto begin()        -> iterator       { return _pixels.begin() + static_cast<ptrdiff_t>(_offset); }
+    auto begin()  const -> const_iterator { return _pixels.begin() + static_cast<ptrdiff_t>(_offset); }
+    auto cbegin() const -> const_iterator { return begin(); }
+    auto end()          -> iterator       { return begin() + static_cast<ptrdiff_t>(_stride * _height); }
+    auto end()    const -> const_iterator { return begin() + static_cast<ptrdiff_t>(_stride * _height); }
+    auto cend()   const -> const_iterator { return end(); }
 
     auto get_pixel_iterator(index_type const x, index_type const y)       -> iterator;
     auto get_pixel_iterator(index_type const x, index_type const y) const -> const_iterator;
@@ -98,11 +171,47 @@ public:
     // drawing
     auto fill(rgba const c) & noexcept -> image &;
 
+    /// Damage tracking, disabled by default: `draw`, `fill`, loading and the in-place effects
+    /// record the area they change, also when done through a viewport. The pixels written
+    /// directly are not tracked, `add_damage` marks them
+    ///
+    /// Like drawing, it is not synchronized: with tracking enabled the threads must not draw on the
+    /// same image at the same time
+    void track_damage(bool const enable = true) noexcept
+    { _damage = enable ? std::optional{_damage.value_or(bounding_box{})} : std::nullopt; }
+    bool tracking_damage() const noexcept { return _damage.has_value(); }
+    /// The smallest box containing the changes since the last `reset_damage`; the whole image if
+    /// the damage is not tracked
+    auto damage() const noexcept { return _damage.value_or(bounding_box{0, 0, _signed(_width), _signed(_height)}); }
+    void add_damage(bounding_box const area) noexcept
+    {
+        if (_damage) {
+            _damage = _damage->unite(area.intersect({0, 0, _signed(_width), _signed(_height)}));
+        }
+    }
+    void reset_damage() noexcept { if (_damage) { _damage = bounding_box{}; } }
+
+    /// The algorithm used by the primitives to compose their colors over the image
+    ///
+    /// Switching from or to `blend_mode::premultiplied` throws `spl::invalid_argument`, as the
+    /// pixels must be converted too: use `premultiply` and `unpremultiply` instead
+    auto blending() const noexcept { return _blending; }
+    auto blending(blend_mode const mode) & -> image &;
+
+    /// Converts the pixels to premultiplied alpha and selects `blend_mode::premultiplied`
+    auto premultiply() & noexcept -> image &;
+    /// Converts the pixels back to straight alpha and selects the default blending
+    auto unpremultiply() & noexcept -> image &;
+    bool premultiplied() const noexcept { return _blending == blend_mode::premultiplied; }
+
     template <drawable ...Ds>
         requires(sizeof...(Ds) >= 1)
     auto draw(Ds &&... objs) & noexcept -> image &
     {
         auto draw_impl = [this]<drawable D>(D && obj) {
+            if (_damage) {
+                add_damage(spl::detail::drawn_area(obj, {0, 0, _signed(_width), _signed(_height)}));
+            }
             if constexpr (spl::detail::has_render_on_member_function<D>) {
                 std::forward<D>(obj).render_on(*this);
             } else {
@@ -114,20 +223,62 @@ public:
     }
 
     // utils
-    auto raw_data()       & noexcept { return _pixels.data(); }
-    auto raw_data() const & noexcept { return _pixels.data(); }
-    bool save_to_file(std::string_view const filename) const;
+    auto get_allocator() const noexcept { return _pixels.get_allocator(); }
+    /// The first pixel; the rows are `stride()` pixels apart
+    auto raw_data()       & noexcept { return row_ptr(0); }
+    auto raw_data() const & noexcept { return row_ptr(0); }
+    /// Saves in the format given by the extension: `.png`, `.jpg`, `.bmp`, `.ppm`, `.pam` or `.spl`,
+    /// the raw native format
+    ///
+    /// PNG is compressed in strips, in parallel according to `options.threads`. The image is
+    /// written to `filename` followed by `.partial`, then renamed: on failure the file is left
+    /// untouched
+    bool save_to_file(std::string_view const filename, save_options const & options = {}) const;
+    /// Loads an image, mapping the file in memory and decoding it as `decode` does
     auto load_from_file(std::filesystem::path const & filename) -> load_status;
 
+    /// Encodes the image in memory; empty on failure
+    auto encode(image_format format, save_options const & options = {}) const -> std::vector<std::byte>;
+    /// Writes the encoded image to `out`; false on failure, when `out` may have been written anyway
+    bool encode(image_format format, std::ostream & out, save_options const & options = {}) const;
+    /// Hands the encoded image to `write` as it is produced, without buffering all of it
+    ///
+    /// `options` has no default, so that `encode(format, {})` still means the overload above
+    bool encode(image_format format, byte_sink const & write, save_options const & options) const;
+    /// Decodes an image from memory, detecting the format from its content
+    ///
+    /// The uncompressed formats (Netpbm, most `.bmp` and `.spl`) are decoded straight into the
+    /// pixels, the others are decoded by stb
+    auto decode(std::span<std::byte const> data) -> load_status;
+
     // viewport
     explicit operator basic_viewport<false>() & noexcept;
     explicit operator basic_viewport<true>() const & noexcept;
 
 private:
-    auto load_ppm(std::filesystem::path const & filename) -> load_status;
+    auto _decode_pnm(std::span<std::byte const> data) -> load_status;
+    auto _decode_bmp(std::span<std::byte const> data) -> load_status;
+    auto _decode_spl(std::span<std::byte const> data) -> load_status;
+    auto _decode_stb(std::span<std::byte const> data) -> load_status;
+    /// Converts the pixels just loaded, with straight alpha, if the image is premultiplied
+    void _premultiply_loaded() noexcept;
+    static constexpr auto _signed(index_type const n) noexcept -> bounding_box::value_type { return static_cast<bounding_box::value_type>(n); }
+    /// Sets the dimensions and allocates the pixels, keeping the layout of the rows; if the
+    /// allocation throws, the image is left as it was
+    void _reshape(index_type w, index_type h);
+    /// The index of the first pixel at an aligned address, or zero if the rows are not aligned
+    auto _first_aligned_pixel() const noexcept -> index_type;
+    /// Moves the pixels, which start at `_pixels.data() + from`, to the first aligned address of
+    /// the storage, if the rows are aligned
+    void _realign(index_type from) noexcept;
 
-    std::vector<rgba> _pixels;
+    std::pmr::vector<rgba> _pixels;
     index_type _width, _height;
+    index_type _stride;
+    index_type _offset = 0;             // the pixels before the first row, to align it
+    bool _aligned_rows = false;
+    blend_mode _blending = default_blend_mode;
+    std::optional<bounding_box> _damage;    // empty if not tracked
 };
 
 } // namespace spl::graphics
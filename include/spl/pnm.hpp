@@ -0,0 +1,108 @@
+/**
+ * @author      : rbrugo, momokrono
+ * @file        : pnm
+ * @created     : Saturday Oct 17, 2026 20:14:36 CEST
+ * @license     : MIT
+ * */
+
+#ifndef PNM_HPP
+#define PNM_HPP
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <span>
+#include <vector>
+
+#include "spl/image.hpp"
+#include "spl/rgba.hpp"
+
+namespace spl::graphics
+{
+
+/// The binary formats of the Netpbm family that can be written
+enum class pnm_format : uint8_t
+{
+    ppm,    ///< P6, without alpha: the pixels are composed on black
+    pam     ///< P7 with `TUPLTYPE RGB_ALPHA`
+};
+
+/// Reads a Netpbm image a row at a time, holding no more than a row in memory
+///
+/// Supports the binary P5, P6 and P7 (with depth from 1 to 4) formats and the ASCII P2 and P3,
+/// with any `MAXVAL`; the channels are scaled to 8 bits.
+class pnm_reader
+{
+public:
+    explicit pnm_reader(std::filesystem::path const & filename);
+    /// Reads from an image already in memory, like a mapped file, which must outlive the reader
+    explicit pnm_reader(std::span<std::byte const> data);
+
+    /// Whether the header has been read successfully; a header promising more rows than the file
+    /// (or the memory) holds is a failure
+    auto status()    const noexcept { return _status; }
+    auto width()     const noexcept { return _width; }
+    auto height()    const noexcept { return _height; }
+    bool has_alpha() const noexcept { return _depth == 2 or _depth == 4; }
+    auto rows_left() const noexcept { return _height - _row; }
+
+    /// Reads the next row in `row`, which must be `width()` pixels long (otherwise throws
+    /// `spl::invalid_argument`); returns false if there are no rows left or the file is truncated
+    bool read_row(std::span<rgba> row);
+
+private:
+    void _start();
+    auto _read_header() -> load_status;
+    auto _read_pam_header() -> load_status;
+
+    std::unique_ptr<std::streambuf> _source;
+    std::istream _in{nullptr};
+    load_status _status = load_status::failure;
+    std::size_t _width  = 0;
+    std::size_t _height = 0;
+    std::size_t _row    = 0;
+    uint16_t _maxval = 0;
+    uint8_t  _depth  = 0;
+    bool     _ascii  = false;
+    std::vector<uint8_t> _buffer;
+};
+
+/// Writes a binary Netpbm image a row at a time, holding no more than a row in memory
+class pnm_writer
+{
+public:
+    pnm_writer(std::filesystem::path const & filename, std::size_t width, std::size_t height, pnm_format format = pnm_format::ppm);
+    /// Writes to the buffer of `out`, which must outlive the writer
+    pnm_writer(std::ostream & out, std::size_t width, std::size_t height, pnm_format format = pnm_format::ppm);
+
+    /// Whether everything has been written successfully so far
+    explicit operator bool() const noexcept { return _out.good(); }
+    auto width()     const noexcept { return _width; }
+    auto height()    const noexcept { return _height; }
+    auto rows_left() const noexcept { return _height - _row; }
+
+    /// Writes the next row, which must be `width()` pixels long (otherwise throws
+    /// `spl::invalid_argument`); returns false if all the rows were already written or on failure
+    bool write_row(std::span<rgba const> row);
+    /// Flushes and closes the file (or flushes the stream); returns false if any row is missing or
+    /// could not be written
+    bool close();
+
+private:
+    void _start();
+
+    std::unique_ptr<std::filebuf> _file;
+    std::ostream _out{nullptr};
+    std::size_t _width  = 0;
+    std::size_t _height = 0;
+    std::size_t _row    = 0;
+    pnm_format _format;
+    std::vector<uint8_t> _buffer;
+};
+
+} // namespace spl::graphics
+
+#endif /* PNM_HPP */
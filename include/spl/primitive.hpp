@@ -10,7 +10,6 @@
 
 #include <cmath>
 #include <cstdint>
-#include <queue>
 #include <span>
 #include <ranges>
 
@@ -18,6 +17,9 @@
 #include "primitives/line.hpp"
 #include "primitives/rectangle.hpp"
 #include "primitives/regular_polygon.hpp"
+#include "primitives/polygon.hpp"
+#include "primitives/polyline.hpp"
+#include "primitives/time_series.hpp"
 #include "primitives/circle.hpp"
 // #include "primitives/vertex_array.hpp"
 
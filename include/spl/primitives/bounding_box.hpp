@@ -0,0 +1,120 @@
+/**
+ * @author      : rbrugo, momokrono
+ * @file        : bounding_box
+ * @created     : Saturday Oct 17, 2026 15:04:11 CEST
+ * @license     : MIT
+ * */
+
+#ifndef PRIMITIVES_BOUNDING_BOX_HPP
+#define PRIMITIVES_BOUNDING_BOX_HPP
+
+#include <algorithm>
+#include <concepts>
+#include <initializer_list>
+#include <optional>
+
+#include "spl/primitives/vertex.hpp"
+
+namespace spl::graphics
+{
+
+/// An axis-aligned rectangle of pixels, `[x0, x1) ⨉ [y0, y1)`
+struct bounding_box
+{
+    using value_type = vertex::value_type;
+
+    value_type x0 = 0;
+    value_type y0 = 0;
+    value_type x1 = 0;
+    value_type y1 = 0;
+
+    /// The smallest box containing every point of `pts`, enlarged by `margin` on every side
+    static constexpr
+    auto around(std::initializer_list<vertex> const pts, value_type const margin = 0) noexcept
+        -> bounding_box
+    {
+        auto const [x_min, x_max] = std::ranges::minmax(pts, std::less{}, &vertex::x);
+        auto const [y_min, y_max] = std::ranges::minmax(pts, std::less{}, &vertex::y);
+        return {x_min.x - margin, y_min.y - margin, x_max.x + margin + 1, y_max.y + margin + 1};
+    }
+
+    constexpr auto width()  const noexcept { return std::max<value_type>(x1 - x0, 0); }
+    constexpr auto height() const noexcept { return std::max<value_type>(y1 - y0, 0); }
+    constexpr bool empty()  const noexcept { return x0 >= x1 or y0 >= y1; }
+
+    constexpr
+    bool contains(value_type const x, value_type const y) const noexcept
+    { return x0 <= x and x < x1 and y0 <= y and y < y1; }
+
+    constexpr
+    bool intersects(bounding_box const & other) const noexcept
+    { return not intersect(other).empty(); }
+
+    /// The common part of the two boxes; empty if they do not overlap
+    constexpr
+    auto intersect(bounding_box const & other) const noexcept
+        -> bounding_box
+    {
+        return {
+            std::max(x0, other.x0), std::max(y0, other.y0),
+            std::min(x1, other.x1), std::min(y1, other.y1)
+        };
+    }
+
+    /// The smallest box containing both boxes
+    constexpr
+    auto unite(bounding_box const & other) const noexcept
+        -> bounding_box
+    {
+        if (empty()) {
+            return other;
+        }
+        if (other.empty()) {
+            return *this;
+        }
+        return {
+            std::min(x0, other.x0), std::min(y0, other.y0),
+            std::max(x1, other.x1), std::max(y1, other.y1)
+        };
+    }
+
+    constexpr
+    auto translate(value_type const x, value_type const y) noexcept
+        -> bounding_box &
+    {
+        x0 += x; x1 += x;
+        y0 += y; y1 += y;
+        return *this;
+    }
+
+    constexpr
+    friend bool operator==(bounding_box const &, bounding_box const &) = default;
+};
+
+} // namespace spl::graphics
+
+namespace spl::detail
+{
+/// A drawable that knows the area it can touch, so that it can be skipped where not needed
+///
+/// `t.bounding_box()` may return an empty optional if the area is not known
+template <typename T>
+concept has_bounding_box = requires (T const & t) {
+    { t.bounding_box() } -> std::convertible_to<std::optional<graphics::bounding_box>>;
+};
+
+/// The area `obj` can touch, or `fallback` if it does not know it
+template <typename T>
+auto drawn_area(T const & obj, graphics::bounding_box const fallback)
+    -> graphics::bounding_box
+{
+    if constexpr (has_bounding_box<T>) {
+        if (auto const box = std::optional<graphics::bounding_box>{obj.bounding_box()}) {
+            return *box;
+        }
+    }
+    return fallback;
+}
+} // namespace spl::detail
+
+#endif /* PRIMITIVES_BOUNDING_BOX_HPP */
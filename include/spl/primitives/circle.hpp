@@ -48,6 +48,10 @@ public:
         }
     }
 
+    constexpr
+    auto bounding_box() const noexcept -> graphics::bounding_box
+    { return graphics::bounding_box::around({_center}, _radius + 1); }
+
     constexpr
     auto traslate(int_fast32_t x, int_fast32_t y) noexcept -> circle & {
         _center += {x, y};
@@ -77,7 +81,7 @@ private:
         auto draw_pixel_with_offset = [&img, x0, y0, color](auto x, auto y) noexcept
         {
             auto & pixel = img.pixel_noexcept(x0 + x, y0 + y);
-            pixel = over(color, pixel);
+            pixel = over(color, pixel, img.blending());
         };
 
         draw_pixel_with_offset( dx,  dy);
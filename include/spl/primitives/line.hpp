@@ -14,36 +14,12 @@
 
 #include "spl/rgba.hpp"
 #include "spl/primitives/vertex.hpp"
+#include "spl/primitives/bounding_box.hpp"
 #include "spl/viewport.hpp"
 
 namespace spl::graphics
 {
 
-namespace detail
-{
-    constexpr
-    auto top_vertex(std::initializer_list<vertex> const & lst) noexcept
-        -> vertex
-    { return std::ranges::max(lst, std::less{}, &vertex::y); }
-
-    constexpr
-    auto segment_compare = [](std::pair<vertex, vertex> const & a, std::pair<vertex, vertex> const & b) noexcept
-    {
-        auto const [a1, a2] = a;
-        auto const [b1, b2] = b;
-        if (auto ay = top_vertex({a1, a2}).y, by = top_vertex({b1, b2}).y; ay < by) {
-            return true;
-        } else if (ay > by) {
-            return false;
-        } else { // ay == by
-            auto const a_bot = std::ranges::min({a1, a2}, std::less{}, &vertex::y).y;
-            auto const b_bot = std::ranges::min({b1, b2}, std::less{}, &vertex::y).y;
-
-            return a_bot < b_bot;
-        }
-    };
-} // namespace detail
-
 struct line
 {
     vertex start;
@@ -89,8 +65,15 @@ struct line
 
     void render_on(viewport img) const noexcept;
 
+    /// The area the line can touch: anti-aliasing and thickness spread it around the segment
+    constexpr
+    auto bounding_box() const noexcept -> graphics::bounding_box
+    { return graphics::bounding_box::around({start, end}, thickness + 1); }
+
     void draw_antialiased_parametric(viewport img) const noexcept;
+    /// Integer Bresenham, starting from the first step inside the clip box
     void draw_aliased(viewport img) const noexcept;
+    /// Xiaolin Wu, starting from the first step near the clip box
     void draw_antialiased(viewport img) const noexcept;
 
     constexpr
@@ -0,0 +1,123 @@
+/**
+ * @author      : rbrugo, momokrono
+ * @file        : polygon
+ * @created     : Sunday Oct 18, 2026 10:12:37 CEST
+ * @license     : MIT
+ * */
+
+#ifndef PRIMITIVES_POLYGON_HPP
+#define PRIMITIVES_POLYGON_HPP
+
+#include <initializer_list>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "spl/rgba.hpp"
+#include "spl/primitives/vertex.hpp"
+#include "spl/primitives/bounding_box.hpp"
+#include "spl/viewport.hpp"
+
+namespace spl::graphics
+{
+
+/// How the inside of a self-intersecting polygon is decided
+enum class fill_rule
+{
+    even_odd,   ///< a point is inside if a ray from it crosses the border an odd number of times
+    non_zero    ///< a point is inside if the border winds around it at least once
+};
+
+namespace detail
+{
+    /// Fills the polygon with the given vertices, which is closed implicitly
+    ///
+    /// The vertices are pixel centers: the pixels whose center is inside are filled, excluding
+    /// the ones on the right and bottom edges, so that adjacent polygons never overlap
+    void fill_polygon(viewport img, std::span<vertex const> vertices, rgba color, fill_rule rule) noexcept;
+
+    /// A point with subpixel precision, in the coordinates of `vertex`
+    struct point
+    {
+        float x;
+        float y;
+    };
+
+    /// Fills the area enclosed by `edges`, any number of closed outlines, blending every pixel
+    /// by the exact area covered
+    ///
+    /// The signed area of every edge is accumulated in a buffer, a band of rows at a time, in
+    /// integer subpixels measured from the image origin; the running sum along a row is the
+    /// coverage of each pixel. Since no rounding depends on the clip box, a clipped or tiled
+    /// render matches the whole one pixel by pixel. The result is exact as long as the
+    /// outlines do not cross each other or themselves: where they do, the rule is applied to the
+    /// accumulated area, so outlines with the same orientation merge with `fill_rule::non_zero`.
+    /// Without anti-aliasing, the pixels covered at least by half are filled.
+    void fill_edges(
+        viewport img, std::span<std::pair<point, point> const> edges, rgba color, fill_rule rule,
+        bool anti_aliasing = true
+    ) noexcept;
+
+    /// Fills the polygon with the given vertices with `fill_edges`
+    void fill_polygon_antialiased(viewport img, std::span<point const> vertices, rgba color, fill_rule rule) noexcept;
+} // namespace detail
+
+/// A closed polygon with any number of vertices, also concave or self-intersecting
+///
+/// With anti-aliasing both the border and the filling are blended with the background
+class polygon
+{
+    std::vector<vertex> _vertices;
+    rgba _border_color = spl::graphics::color::black;
+    rgba _fill_color   = spl::graphics::color::nothing;
+    fill_rule _rule    = fill_rule::non_zero;
+    bool _anti_aliasing = false;
+
+public:
+    polygon() = default;
+
+    polygon(std::initializer_list<vertex> const vertices, bool antialiasing = false) :
+        _vertices{vertices}, _anti_aliasing{antialiasing}
+    {}
+
+    explicit
+    polygon(std::vector<vertex> vertices, bool antialiasing = false) noexcept :
+        _vertices{std::move(vertices)}, _anti_aliasing{antialiasing}
+    {}
+
+    auto border_color(spl::graphics::rgba const fill) noexcept
+        -> polygon &
+    { _border_color = fill; return *this; }
+
+    auto fill_color(spl::graphics::rgba const fill) noexcept
+        -> polygon &
+    { _fill_color = fill; return *this; }
+
+    auto rule(fill_rule const rule) noexcept
+        -> polygon &
+    { _rule = rule; return *this; }
+    auto rule() const noexcept { return _rule; }
+
+    auto push(vertex const v)
+        -> polygon &
+    { _vertices.push_back(v); return *this; }
+    void clear() noexcept { _vertices.clear(); }
+    void reserve(std::size_t n) { _vertices.reserve(n); }
+    auto vertices() const noexcept -> std::span<vertex const> { return _vertices; }
+
+    auto translate(int_fast32_t x, int_fast32_t y) noexcept
+        -> polygon &
+    {
+        for (auto & v : _vertices) {
+            v += {x, y};
+        }
+        return *this;
+    }
+
+    void render_on(viewport img) const noexcept;
+    auto bounding_box() const noexcept -> graphics::bounding_box;
+};
+
+} // namespace spl::graphics
+
+#endif /* PRIMITIVES_POLYGON_HPP */
@@ -0,0 +1,101 @@
+/**
+ * @author      : rbrugo, momokrono
+ * @file        : polyline
+ * @created     : Sunday Oct 18, 2026 16:40:02 CEST
+ * @license     : MIT
+ * */
+
+#ifndef PRIMITIVES_POLYLINE_HPP
+#define PRIMITIVES_POLYLINE_HPP
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "spl/rgba.hpp"
+#include "spl/primitives/vertex.hpp"
+#include "spl/primitives/bounding_box.hpp"
+#include "spl/viewport.hpp"
+
+namespace spl::graphics
+{
+
+/// The shape of the corners of a thick polyline
+enum class line_join
+{
+    miter,  ///< the outer borders are extended until they meet, up to `polyline::miter_limit`
+    round,  ///< a circular arc around the vertex
+    bevel   ///< the outer borders are joined by a straight cut
+};
+
+/// An open path through many points, drawn at once
+///
+/// The segments do not touch twice the pixels they share, so a translucent path has the same
+/// color everywhere. A thick path is filled as a single shape, with the corners given by the
+/// join and flat ends; the parts outside of the viewport are discarded before rasterizing.
+class polyline
+{
+    std::vector<vertex> _points;
+    rgba _color = spl::graphics::color::black;
+    int16_t _thickness = 1;
+    line_join _join = line_join::miter;
+    bool _anti_aliasing = true;
+
+public:
+    /// The longest miter, in units of half the thickness, before falling back to a bevel
+    static constexpr float miter_limit = 4.f;
+
+    polyline() = default;
+
+    explicit
+    polyline(std::vector<vertex> points, rgba color = spl::graphics::color::black, bool antialiasing = true) noexcept :
+        _points{std::move(points)}, _color{color}, _anti_aliasing{antialiasing}
+    {}
+
+    explicit
+    polyline(std::span<vertex const> const points, rgba color = spl::graphics::color::black, bool antialiasing = true) :
+        _points{points.begin(), points.end()}, _color{color}, _anti_aliasing{antialiasing}
+    {}
+
+    auto color(rgba const c) noexcept
+        -> polyline &
+    { _color = c; return *this; }
+    auto color() const noexcept { return _color; }
+
+    auto thickness(int16_t const t) noexcept
+        -> polyline &
+    { _thickness = t; return *this; }
+    auto thickness() const noexcept { return _thickness; }
+
+    auto join(line_join const j) noexcept
+        -> polyline &
+    { _join = j; return *this; }
+    auto join() const noexcept { return _join; }
+
+    auto push(vertex const v)
+        -> polyline &
+    { _points.push_back(v); return *this; }
+    void clear() noexcept { _points.clear(); }
+    void reserve(std::size_t n) { _points.reserve(n); }
+    auto points() const noexcept -> std::span<vertex const> { return _points; }
+
+    auto translate(int_fast32_t x, int_fast32_t y) noexcept
+        -> polyline &
+    {
+        for (auto & v : _points) {
+            v += {x, y};
+        }
+        return *this;
+    }
+
+    void render_on(viewport img) const noexcept;
+    auto bounding_box() const noexcept -> graphics::bounding_box;
+
+private:
+    void _draw_thin(viewport img) const noexcept;
+    void _draw_thick(viewport img) const noexcept;
+};
+
+} // namespace spl::graphics
+
+#endif /* PRIMITIVES_POLYLINE_HPP */
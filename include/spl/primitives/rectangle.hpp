@@ -8,6 +8,7 @@
 #ifndef PRIMITIVES_RECTANGLE_HPP
 #define PRIMITIVES_RECTANGLE_HPP
 
+#include <array>
 #include <cstdint>
 #include <utility>
 
@@ -54,6 +55,7 @@ public:
     { _fill_color = fill; return *this; }
 
     void render_on(viewport img) const noexcept;
+    auto bounding_box() const noexcept -> graphics::bounding_box;
 
     constexpr
     auto translate(int_fast32_t x, int_fast32_t y) noexcept -> rectangle & {
@@ -85,6 +87,8 @@ public:
         return *this;
     }
 
+private:
+    auto _corners() const noexcept -> std::array<vertex, 4>;
 };
 
 } // namespace spl::graphics
@@ -54,6 +54,8 @@ public:
         }
     }
 
+    auto bounding_box() const noexcept -> graphics::bounding_box;
+
 private:
     void _draw_filled(viewport img) const noexcept;
     void _draw_unfilled(viewport img) const noexcept;
@@ -0,0 +1,80 @@
+/**
+ * @author      : rbrugo, momokrono
+ * @file        : time_series
+ * @created     : Monday Oct 19, 2026 09:21:47 CEST
+ * @license     : MIT
+ * */
+
+#ifndef PRIMITIVES_TIME_SERIES_HPP
+#define PRIMITIVES_TIME_SERIES_HPP
+
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "spl/rgba.hpp"
+#include "spl/primitives/vertex.hpp"
+#include "spl/viewport.hpp"
+
+namespace spl::graphics
+{
+
+/// A plot of the samples `(x[i], y[i])`, stretched over the whole viewport it is drawn on
+///
+/// The samples are not copied, so they must outlive the object; `x` must be sorted in ascending
+/// order and every value must be finite. Before drawing, the samples falling on the same pixel
+/// column are reduced to the first, the last, the lowest and the highest one: the line through
+/// them touches the same pixels as the one through every sample, so an aliased, opaque plot is
+/// identical while only a few segments per column are rasterized.
+class time_series
+{
+    std::span<double const> _x;
+    std::span<double const> _y;
+    std::optional<std::pair<double, double>> _x_range;
+    std::optional<std::pair<double, double>> _y_range;
+    rgba _color = spl::graphics::color::black;
+    int16_t _thickness = 1;
+    bool _anti_aliasing = false;
+
+public:
+    /// Throws `spl::invalid_argument` if `x` and `y` have a different size
+    time_series(
+        std::span<double const> x, std::span<double const> y,
+        rgba color = spl::graphics::color::black, bool antialiasing = false
+    );
+
+    /// The values mapped to the left and the right border; by default, the first and the last `x`
+    ///
+    /// Throws `spl::invalid_argument` unless `lo < hi`
+    auto x_range(double lo, double hi)
+        -> time_series &;
+
+    /// The values mapped to the bottom and the top border; by default, the lowest and the highest `y`
+    ///
+    /// Throws `spl::invalid_argument` unless `lo < hi`
+    auto y_range(double lo, double hi)
+        -> time_series &;
+
+    auto color(rgba const c) noexcept
+        -> time_series &
+    { _color = c; return *this; }
+    auto color() const noexcept { return _color; }
+
+    auto thickness(int16_t const t) noexcept
+        -> time_series &
+    { _thickness = t; return *this; }
+    auto thickness() const noexcept { return _thickness; }
+
+    /// The pixels of the line drawn on a `width` ⨉ `height` viewport, at most four per column,
+    /// plus the closest sample on each side outside of it
+    auto decimate(int_fast32_t width, int_fast32_t height) const
+        -> std::vector<vertex>;
+
+    void render_on(viewport img) const noexcept;
+};
+
+} // namespace spl::graphics
+
+#endif /* PRIMITIVES_TIME_SERIES_HPP */
@@ -1,8 +1,13 @@
 #ifndef RGBA_HPP
 #define RGBA_HPP
 
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
 #include <cstdint>
 #include <concepts>
+#include <span>
 
 #include "spl/detail/exceptions.hpp"
 
@@ -54,6 +59,72 @@ struct rgba
     friend bool operator==(rgba, rgba) = default;
 };
 
+/// A color whose channels are already multiplied by its alpha
+///
+/// Composing premultiplied colors requires neither divisions nor floating point math
+struct rgba_premul
+{
+    uint8_t r;
+    uint8_t g;
+    uint8_t b;
+    uint8_t a;
+
+    [[nodiscard]] constexpr inline
+    auto to_rgb() const noexcept
+    { return rgba{r, g, b, 255}; }
+
+    constexpr
+    friend bool operator==(rgba_premul, rgba_premul) = default;
+};
+
+namespace detail
+{
+    /// `x * y / 255`, rounded to the nearest integer, without the division
+    constexpr inline
+    auto mul_div255(uint32_t const x, uint32_t const y) noexcept
+        -> uint8_t
+    {
+        auto const t = x * y + 128;
+        return static_cast<uint8_t>((t + (t >> 8)) >> 8);
+    }
+} // namespace detail
+
+[[nodiscard]] constexpr inline
+auto premultiply(rgba const c) noexcept
+    -> rgba_premul
+{
+    using detail::mul_div255;
+    return {mul_div255(c.r, c.a), mul_div255(c.g, c.a), mul_div255(c.b, c.a), c.a};
+}
+
+[[nodiscard]] constexpr inline
+auto unpremultiply(rgba_premul const c) noexcept
+    -> rgba
+{
+    if (c.a == 0) {
+        return {0, 0, 0, 0};
+    }
+    auto const unpremultiply_impl = [a = c.a](uint8_t x) noexcept {
+        return static_cast<uint8_t>(std::min((x * 255u + a / 2u) / a, 255u));
+    };
+    return {unpremultiply_impl(c.r), unpremultiply_impl(c.g), unpremultiply_impl(c.b), c.a};
+}
+
+/// Composes two premultiplied colors; only multiplications and additions are involved
+constexpr inline
+auto over_premul(rgba_premul const foreground, rgba_premul const background) noexcept
+    -> rgba_premul
+{
+    using detail::mul_div255;
+    auto const k = 255u - foreground.a;
+    return {
+        static_cast<uint8_t>(foreground.r + mul_div255(background.r, k)),
+        static_cast<uint8_t>(foreground.g + mul_div255(background.g, k)),
+        static_cast<uint8_t>(foreground.b + mul_div255(background.b, k)),
+        static_cast<uint8_t>(foreground.a + mul_div255(background.a, k))
+    };
+}
+
 
 constexpr
 auto over_no_gamma(rgba const foreground, rgba const background)
@@ -87,15 +158,8 @@ auto grayscale(rgba p)
 	return rgba{rgb,rgb,rgb,p.a};
 }
 
-#ifdef SPL_DISABLE_GAMMA_CORRECTION
 constexpr
-auto over(rgba const foreground, rgba const background)
-{
-    return over_no_gamma(foreground, background);
-}
-#else
-constexpr
-auto over(rgba const foreground, rgba const background)
+auto over_gamma(rgba const foreground, rgba const background)
     -> rgba
 {
     auto const [r1, g1, b1, a1] = foreground;
@@ -115,7 +179,138 @@ auto over(rgba const foreground, rgba const background)
         static_cast<uint8_t>((k1 + k2) * 255)
     };
 }
+
+constexpr
+auto over(rgba const foreground, rgba const background)
+    -> rgba
+{
+#ifdef SPL_DISABLE_GAMMA_CORRECTION
+    return over_no_gamma(foreground, background);
+#else
+    return over_gamma(foreground, background);
 #endif
+}
+
+namespace detail
+{
+    /// Maps a gamma-encoded channel to its linear value; the gamma is the same as `over_gamma`,
+    /// so the table holds the squares of the indexes
+    extern std::array<uint16_t, 256> const gamma_to_linear;
+    /// The inverse of `gamma_to_linear`, the integer square root of the index
+    extern std::array<uint8_t, 65536> const linear_to_gamma;
+} // namespace detail
+
+/// Gamma-correct composition computed with lookup tables and integer arithmetic
+///
+/// The result is the exact one `over_gamma` approximates with floating point math, so the two
+/// may differ by 1 in some channels
+inline
+auto over_lut(rgba const foreground, rgba const background) noexcept
+    -> rgba
+{
+    auto const [r1, g1, b1, a1] = foreground;
+    auto const [r2, g2, b2, a2] = background;
+    auto const & to_linear = detail::gamma_to_linear;
+    auto const & to_gamma  = detail::linear_to_gamma;
+
+    // The background is usually opaque: the divisor is then a constant, and the compiler turns
+    // the division into a multiplication
+    if (a2 == 255) {
+        auto const over_impl = [a1](uint8_t c1, uint8_t c2) noexcept {
+            return to_gamma[(to_linear[c1] * a1 + to_linear[c2] * (255u - a1)) / 255u];
+        };
+        return {over_impl(r1, r2), over_impl(g1, g2), over_impl(b1, b2), 255};
+    }
+
+    // weights of the two colors, multiplied by 255²
+    auto const w1 = a1 * 255u;
+    auto const w2 = (255u - a1) * a2;
+    auto const w  = w1 + w2;
+    if (w == 0) {
+        return {0, 0, 0, 0};
+    }
+
+    auto const over_impl = [w1, w2, w](uint8_t c1, uint8_t c2) noexcept {
+        return to_gamma[(to_linear[c1] * w1 + to_linear[c2] * w2) / w];
+    };
+
+    return {
+        over_impl(r1, r2),
+        over_impl(g1, g2),
+        over_impl(b1, b2),
+        static_cast<uint8_t>(w / 255)
+    };
+}
+
+/// The algorithm used to compose two colors
+enum class blend_mode : uint8_t
+{
+    no_gamma,   ///< composes the channel values as they are, see `over_no_gamma`
+    gamma,      ///< gamma-correct composition with floating point math, see `over_gamma`
+    gamma_lut,  ///< gamma-correct composition with lookup tables, see `over_lut`
+    /// the background stores premultiplied colors, see `over_premul`; the foreground is still
+    /// a straight color, and it is premultiplied before the composition
+    premultiplied,
+};
+
+#ifdef SPL_DISABLE_GAMMA_CORRECTION
+constexpr inline auto default_blend_mode = blend_mode::no_gamma;
+#else
+constexpr inline auto default_blend_mode = blend_mode::gamma;
+#endif
+
+inline
+auto over(rgba const foreground, rgba const background, blend_mode const mode) noexcept
+    -> rgba
+{
+    switch (mode) {
+    case blend_mode::no_gamma:  return over_no_gamma(foreground, background);
+    case blend_mode::gamma:     return over_gamma(foreground, background);
+    case blend_mode::gamma_lut: return over_lut(foreground, background);
+    case blend_mode::premultiplied:
+        return std::bit_cast<rgba>(over_premul(premultiply(foreground), std::bit_cast<rgba_premul>(background)));
+    }
+    return over(foreground, background);
+}
+
+/// The value to store in a pixel to obtain `color` with the given blending: `premultiplied`
+/// images store premultiplied colors, every other mode stores them straight
+constexpr inline
+auto stored_color(rgba const color, blend_mode const mode) noexcept
+    -> rgba
+{
+    if (mode == blend_mode::premultiplied) {
+        return std::bit_cast<rgba>(premultiply(color));
+    }
+    return color;
+}
+
+/// Composes `foreground` over every pixel of `background`, in place
+///
+/// Equivalent to calling `over(foreground, px, mode)` on every pixel `px` of `background`, but
+/// the pixels are processed in blocks using SIMD instructions when available
+void over_span(rgba foreground, std::span<rgba> background, blend_mode mode = default_blend_mode) noexcept;
+
+/// Composes `foreground` over every pixel of `background`, scaling its alpha by the coverage
+///
+/// Equivalent to calling `over(foreground.blend(coverage[i]), background[i], mode)`; only the
+/// first `min(coverage.size(), background.size())` pixels are processed
+void over_span(
+    rgba foreground, std::span<uint8_t const> coverage, std::span<rgba> background,
+    blend_mode mode = default_blend_mode
+) noexcept;
+
+/// Composes every pixel of `foreground` over the corresponding pixel of `background`, in place
+///
+/// Only the first `min(foreground.size(), background.size())` pixels are processed
+void over_span(
+    std::span<rgba const> foreground, std::span<rgba> background, blend_mode mode = default_blend_mode
+) noexcept;
+
+/// Composes every premultiplied pixel of `foreground` over the corresponding one of `background`
+///
+/// Only the first `min(foreground.size(), background.size())` pixels are processed
+void over_span(std::span<rgba_premul const> foreground, std::span<rgba_premul> background) noexcept;
 
 namespace color
 {
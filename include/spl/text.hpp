@@ -8,19 +8,29 @@
 #ifndef SPL_TEXT_HPP
 #define SPL_TEXT_HPP
 
-#include <map>
+#include <algorithm>
+#include <cmath>
 #include <string>
+#include <string_view>
 #include <memory>
 #include <filesystem>
+#include <vector>
 
 #include "spl/rgba.hpp"
 #include "spl/viewport.hpp"
+#include "spl/primitives/bounding_box.hpp"
+
+namespace spl::detail
+{
+class glyph_cache;
+} // namespace spl::detail
 
 namespace spl::graphics
 {
 
 class font;
 class font_face;
+class text_run;
 class text;
 
 namespace detail {
@@ -37,6 +47,7 @@ private:
     std::shared_ptr<impl> _impl;
 
     [[nodiscard]] decltype(auto) face_info() const;
+    [[nodiscard]] auto glyphs() const -> spl::detail::glyph_cache &;
 public:
     font_face(font_face &&) = default;
     font_face(font_face const &) = default;
@@ -46,24 +57,18 @@ public:
     auto operator=(font_face const &) -> font_face & = default;
 };
 
+/// A face at a given size; every copy of a face, and every font made from it, shares the cache
+/// of the glyphs already rasterized
 class font
 {
-    struct preallocated_codepoint
-    {
-        preallocated_codepoint(int w, int h, int x, int y, std::shared_ptr<uint8_t []> && d) :
-            width(w), height(h), x_off(x), y_off(y), data(std::move(d))
-        {}
-        int width, height, x_off, y_off;
-        std::shared_ptr<uint8_t []> data;
-    };
-
     font_face _face;
     float _height;
-    mutable std::map<int32_t, preallocated_codepoint> _buffer;
 
     friend class text;
+    friend class text_run;
 
     [[nodiscard]] decltype(auto) face_info() const;
+    [[nodiscard]] auto glyphs() const -> spl::detail::glyph_cache &;
 public:
     font(font_face face, float height_px) :
         _face(std::move(face)),
@@ -75,32 +80,128 @@ public:
     {}
 };
 
+/// A string decoded and laid out once with a font, to be measured and drawn many times
+///
+/// The glyphs are placed along the baseline starting from `(0, 0)`, with kerning; every `'\n'`
+/// moves to the start of the next line. Throws `spl::utf8_error` if `text` is not valid UTF-8.
+///
+/// With `distance_field`, every glyph is scaled from a signed distance field made once per face,
+/// instead of being rasterized for every size; the edges are a bit softer, and the outline and
+/// the glow are available. The field reaches `12 * height / 48` pixels out of the glyphs, which
+/// bounds the width of the effects.
+class text_run
+{
+    struct glyph
+    {
+        int32_t codepoint;
+        int32_t x;                      ///< the pen position, rounded down
+        int32_t y;                      ///< the baseline
+        uint8_t shift;                  ///< the rest of the pen position, in subpixel steps
+        int16_t x0, y0, x1, y1;         ///< the pixels covered, from the pen position
+    };
+
+    font _font;
+    std::vector<glyph> _glyphs;
+    graphics::bounding_box _box;
+    float _advance = 0.f;
+    int32_t _line_height = 0;
+    std::size_t _lines = 1;
+    bool _distance_field = false;
+    rgba _outline_color = color::nothing;
+    float _outline_width = 0.f;
+    rgba _glow_color = color::nothing;
+    float _glow_radius = 0.f;
+
+    void _draw_distance_field(viewport img, vertex origin, rgba color) const noexcept;
+
+public:
+    text_run(std::string_view text, font const & f);
+
+    auto distance_field(bool const enable) noexcept
+        -> text_run &
+    { _distance_field = enable; return *this; }
+    auto distance_field() const noexcept { return _distance_field; }
+
+    /// A border `width` pixels wide around the glyphs; enables `distance_field`
+    auto outline(rgba const color, float const width) noexcept
+        -> text_run &
+    {
+        _outline_color = color;
+        _outline_width = std::max(width, 0.f);
+        _distance_field = true;
+        return *this;
+    }
+
+    /// A halo fading out in `radius` pixels around the glyphs and their outline; enables `distance_field`
+    auto glow(rgba const color, float const radius) noexcept
+        -> text_run &
+    {
+        _glow_color = color;
+        _glow_radius = std::max(radius, 0.f);
+        _distance_field = true;
+        return *this;
+    }
+
+    /// The pixels covered by the glyphs, with the origin on the first baseline
+    auto bounding_box() const noexcept
+        -> graphics::bounding_box
+    {
+        if (not _distance_field or _box.empty()) {
+            return _box;
+        }
+        auto const reach = static_cast<graphics::bounding_box::value_type>(std::ceil(_outline_width + _glow_radius)) + 1;
+        return {_box.x0 - reach, _box.y0 - reach, _box.x1 + reach, _box.y1 + reach};
+    }
+    /// The width of the longest line, from the origin to the end of its last advance
+    auto advance() const noexcept { return _advance; }
+    /// The distance between two baselines
+    auto line_height() const noexcept { return _line_height; }
+    auto lines() const noexcept { return _lines; }
+
+    void render_on(viewport img, vertex origin, rgba color) const noexcept;
+};
+
 class text
 {
     vertex _origin;
-    std::string _text;
-    mutable font _font;
+    text_run _run;
     rgba _color;
 
 public:
-    text(vertex const & baseline_origin, std::string text, font const & f, rgba color = color::black) :
-        _origin{baseline_origin}, _text{std::move(text)}, _font{f}, _color{color}
+    text(vertex const & baseline_origin, text_run run, rgba color = color::black) :
+        _origin{baseline_origin}, _run{std::move(run)}, _color{color}
+    {}
+    text(vertex const & baseline_origin, std::string_view text, font const & f, rgba color = color::black) :
+        _origin{baseline_origin}, _run{text, f}, _color{color}
     {}
     text(
-        vertex const & baseline_origin, std::string text, font const & f, float height_px,
+        vertex const & baseline_origin, std::string_view text, font const & f, float height_px,
         rgba color = color::black
     ) :
-        _origin{baseline_origin}, _text{std::move(text)}, _font{f._face, height_px}, _color{color}
+        _origin{baseline_origin}, _run{text, font{f._face, height_px}}, _color{color}
     {}
     text(
-        vertex const & baseline_origin, std::string text,
+        vertex const & baseline_origin, std::string_view text,
         std::filesystem::path const & font_source, float height_px, rgba color = color::black
     ) :
-        _origin{baseline_origin}, _text{std::move(text)}, _font{font_source, height_px}, _color{color}
+        _origin{baseline_origin}, _run{text, font{font_source, height_px}}, _color{color}
     {}
 
-    void render_on(viewport img) const noexcept;
+    auto origin(vertex const & baseline_origin) noexcept
+        -> text &
+    { _origin = baseline_origin; return *this; }
+    auto origin() const noexcept { return _origin; }
+    auto run() const noexcept -> text_run const & { return _run; }
+
+    auto bounding_box() const noexcept
+        -> graphics::bounding_box
+    {
+        auto const box = _run.bounding_box();
+        return {box.x0 + _origin.x, box.y0 + _origin.y, box.x1 + _origin.x, box.y1 + _origin.y};
+    }
 
+    void render_on(viewport img) const noexcept
+    { _run.render_on(img, _origin, _color); }
 };
 
 } // namespace spl::graphics
@@ -42,6 +42,8 @@ private:
     image_t * _base = nullptr;
     index_type _x = 0, _y = 0;
     size_t _width = 0, _height = 0;
+    bounding_box _clip{};
+    blend_mode _blending = default_blend_mode;
     // float rotation = 0.f;
 
 public:
@@ -54,6 +56,8 @@ public:
         _y = std::exchange(other._y, 0);
         _width  = std::exchange(other._width, 0);
         _height = std::exchange(other._height, 0);
+        _clip = std::exchange(other._clip, {});
+        _blending = other._blending;
     }
 
     template <std::integral Int1, std::integral Int2>
@@ -62,13 +66,17 @@ public:
     ) :
         _base{img._base},
         _x{img._x + x_off}, _y{img._y + y_off},
-        _width{static_cast<size_t>(w)}, _height{static_cast<size_t>(h)}
+        _width{static_cast<size_t>(w)}, _height{static_cast<size_t>(h)},
+        _clip{img._clip.translate(-x_off, -y_off).intersect(_full_box())},
+        _blending{img._blending}
     {}
 
     constexpr basic_viewport(basic_viewport img, index_type x_off, index_type y_off) :
         _base{img._base},
         _x{img._x + x_off}, _y{img._y + y_off},
-        _width{img.width()}, _height{img.height()}
+        _width{img.width()}, _height{img.height()},
+        _clip{img._clip.translate(-x_off, -y_off).intersect(_full_box())},
+        _blending{img._blending}
     {}
 
     // TODO: want to disable rvalues for img, how to do it?
@@ -77,14 +85,18 @@ public:
     constexpr basic_viewport(image_t & img, index_type x_off, index_type y_off, Int1 w, Int2 h) :
         _base{std::addressof(img)},
         _x{x_off}, _y{y_off},
-        _width{static_cast<size_t>(w)}, _height{static_cast<size_t>(h)}
+        _width{static_cast<size_t>(w)}, _height{static_cast<size_t>(h)},
+        _clip{_full_box().intersect(_base_box())},
+        _blending{img.blending()}
     {}
 
     explicit
     constexpr basic_viewport(image_t & img, index_type x_off, index_type y_off) :
         _base{std::addressof(img)},
         _x{x_off}, _y{y_off},
-        _width{img.width() - x_off}, _height{img.height() - y_off}
+        _width{img.width() - x_off}, _height{img.height() - y_off},
+        _clip{_full_box().intersect(_base_box())},
+        _blending{img.blending()}
     {}
 
     // TODO: want to disable rvalues for img, how to do it?
@@ -93,7 +105,9 @@ public:
     constexpr basic_viewport(basic_viewport<false> const & v) requires (Const) :
         _base{v._base},
         _x{v._x}, _y{v._y},
-        _width{v._width}, _height{v._height}
+        _width{v._width}, _height{v._height},
+        _clip{v._clip},
+        _blending{v._blending}
     {}
 
     auto pixel(index_type const x, index_type const y)       -> reference;
@@ -106,6 +120,17 @@ public:
     auto pixel_noexcept(vertex const pt)       noexcept -> reference       { return pixel_noexcept(pt.x, pt.y); }
     auto pixel_noexcept(vertex const pt) const noexcept -> const_reference { return pixel_noexcept(pt.x, pt.y); }
 
+    /// Access without any check, for the primitives: the coordinates must be in `clip_box()`
+    auto pixel_unchecked(index_type const x, index_type const y)       noexcept -> reference       { return row_ptr(y)[x]; }
+    auto pixel_unchecked(index_type const x, index_type const y) const noexcept -> const_reference { return row_ptr(y)[x]; }
+
+    /// The pixel `(0, y)` of the viewport; the following rows are `stride()` pixels apart
+    auto row_ptr(index_type const y) noexcept
+    { return _base->row_ptr(0) + (_y + y) * static_cast<std::ptrdiff_t>(stride()) + _x; }
+    auto row_ptr(index_type const y) const noexcept -> rgba const *
+    { return std::as_const(*_base).row_ptr(0) + (_y + y) * static_cast<std::ptrdiff_t>(stride()) + _x; }
+    auto stride() const noexcept { return _base->stride(); }
+
     auto row(size_t const y)            -> row_view;
     auto row(size_t const y) const      -> const_row_view;
 
@@ -127,16 +152,45 @@ public:
 
     auto offset()      const noexcept { return std::pair{_x, _y}; }
 
+    /// The area where the primitives are allowed to draw, in the coordinates of the viewport
+    ///
+    /// It is the part of the viewport inside the base image unless restricted with `clip`; the
+    /// pixels outside of it are still accessible with `pixel`, but `pixel_noexcept` treats them as
+    /// out of range
+    auto clip_box()    const noexcept { return _clip; }
+    auto clip(bounding_box const area) &  noexcept -> basic_viewport & { _clip = _clip.intersect(area); return *this; }
+    auto clip(bounding_box const area) && noexcept -> basic_viewport   { _clip = _clip.intersect(area); return std::move(*this); }
+
+    /// The algorithm used by the primitives to compose their colors, inherited from the base image
+    ///
+    /// It can be changed to draw a single object with a different algorithm, without changing
+    /// the one of the image:
+    /// `auto v = viewport{img}.blending(blend_mode::gamma_lut); v.draw(obj);`
+    ///
+    /// Like for the image, switching from or to `blend_mode::premultiplied` throws
+    /// `spl::invalid_argument`
+    auto blending() const noexcept { return _blending; }
+    auto blending(blend_mode const mode) &  -> basic_viewport &;
+    auto blending(blend_mode const mode) && -> basic_viewport;
+
     // bool empty()       const noexcept { return _pixels.empty(); }
 
     auto fill(rgba const c) &  noexcept -> basic_viewport & requires (not Const);
     auto fill(rgba const c) && noexcept -> basic_viewport   requires (not Const);
 
+    /// Marks `area`, in the coordinates of the viewport, as changed in the base image if it is
+    /// tracking the damage
+    void add_damage(bounding_box area) noexcept requires (not Const)
+    { _base->add_damage(area.translate(_x, _y)); }
+
     template <drawable ...Ds>
         requires(sizeof...(Ds) >= 1)
     auto draw(Ds &&... objs) & noexcept -> basic_viewport & requires (not Const)
     {
         auto draw_impl = [this]<drawable D>(D && obj) {
+            if (_base->tracking_damage()) {
+                add_damage(spl::detail::drawn_area(obj, _clip).intersect(_clip));
+            }
             if constexpr (spl::detail::has_render_on_member_function<D>) {
                 std::forward<D>(obj).render_on(*this);
             } else {
@@ -158,6 +212,14 @@ public:
 
     auto cbegin() const noexcept { return const_iterator{*this}; }
     auto cend() const noexcept { return const_iterator{*this, 0, sheight()}; }
+
+private:
+    constexpr auto _full_box() const noexcept -> bounding_box
+    { return {0, 0, static_cast<index_type>(_width), static_cast<index_type>(_height)}; }
+
+    /// The base image, in the coordinates of the viewport
+    constexpr auto _base_box() const noexcept -> bounding_box
+    { return {-_x, -_y, static_cast<index_type>(_base->width()) - _x, static_cast<index_type>(_base->height()) - _y}; }
 };
 
 using viewport = basic_viewport<false>;
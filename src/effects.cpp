@@ -6,8 +6,14 @@
  */
 
 #include "spl/effects.hpp"
+#include "spl/executor.hpp"
 #include "fmt/core.h"
-#include <thread>
+
+#include <array>
+#include <memory_resource>
+#include <span>
+#include <tuple>
+#include <vector>
 
 namespace spl::graphics
 {
@@ -102,89 +108,146 @@ void _triangular_blur(int16_t radius, viewport output, image_view original)
     }
 }
 
+/// Reflects the coordinate `z` inside `[0, size)` the same way `_effective_coordinates` does,
+/// clamping what is still outside when the radius exceedes the image size
+auto _reflect(std::ptrdiff_t z, std::ptrdiff_t const size) noexcept
+    -> std::ptrdiff_t
+{
+    if (z >= size) {
+        z = 2 * size - z - 1;
+    } else if (z < 0) {
+        z = -z;
+    }
+    return std::clamp<std::ptrdiff_t>(z, 0, size - 1);
+}
+
+/// Blurs `output` averaging the squares of the channels over a square of side `2 * radius + 1`
+///
+/// The filter is separable: every source row is summed horizontally with a sliding window, and
+/// the last `2 * radius + 1` row sums are kept in a ring, whose running total over the columns
+/// gives the square sums. Each pixel costs a constant number of operations whatever the radius.
 void _box_blur(int16_t radius, viewport output, image_view original)
 {
     if (output.height() == 0 or output.width() == 0) {
         return;
     }
-    auto const sqrt_norm_factor = 1. / (2 * radius + 1);
-    auto [x0, y0] = output.offset();
-
-    auto sum_sq_column = [radius, &original](int_fast32_t col, int_fast32_t y)
-    {
-        auto [r, g, b, a] = std::array{0, 0, 0, 0};
-        for (int_fast32_t t = y - radius; t <= y + radius; ++t) {
-            auto [effective_x, effective_y] = _effective_coordinates(col, t, original);
-            auto [r_, g_, b_, a_] = original.base().pixel(effective_x, effective_y);
-            r += r_ * r_;
-            g += g_ * g_;
-            b += b_ * b_;
-            a += a_;
-        }
-        return std::array<int_fast32_t, 4>{r, g, b, a};
-    };  // in the output frame of reference
-
-    auto sum_sq_row = [radius, &original](int_fast32_t x, int_fast32_t row)
-    {
-        auto [r, g, b, a] = std::array{0, 0, 0, 0};
-        for (int_fast32_t t = x - radius; t <= x + radius; ++t) {
-            auto [effective_x, effective_y] = _effective_coordinates(t, row, original);
-            auto [r_, g_, b_, _a] = original.base().pixel(effective_x, effective_y);
-            r += r_ * r_;
-            g += g_ * g_;
-            b += b_ * b_;
-            a += _a;
-        }
-        return std::array<int_fast32_t, 4>{r, g, b, a};
-    };  // in the output frame of reference
-
-
-    // First avg computation
-    auto [r, g, b, a] = std::array{0, 0, 0, 0}; // y_avg;
-    for (int t = -radius; t <= radius; ++t) {
-        auto const [r_, g_, b_, a_] = sum_sq_column(x0 + t, y0);
-        r += r_;
-        g += g_;
-        b += b_;
-        a += a_;
-    }
-
-    auto y = 0;
-    while (true) {
-        auto x_r = r;
-        auto x_g = g;
-        auto x_b = b;
-        auto x_a = a;
-
-        auto x = 0;
-        while (true) {
-            output.pixel(x, y) = rgba{
-                static_cast<uint8_t>(std::sqrt(x_r) * sqrt_norm_factor),
-                static_cast<uint8_t>(std::sqrt(x_g) * sqrt_norm_factor),
-                static_cast<uint8_t>(std::sqrt(x_b) * sqrt_norm_factor),
-                static_cast<uint8_t>(a * sqrt_norm_factor * sqrt_norm_factor)
-            };
-            ++x;
-            if (x >= output.swidth()) {
-                break;
+    radius = std::max<int16_t>(radius, 0);
+    auto const side = 2 * static_cast<std::size_t>(radius) + 1;
+    auto const sqrt_norm_factor = 1. / static_cast<double>(side);
+    auto const width = output.width();
+    auto const [x0, y0] = output.offset();  // in the output frame of reference
+    auto const [ox, oy] = original.offset();
+    auto const & base = original.base();
+
+    // interleaved r², g², b², a for each pixel, first of the reflected row and then of the sums.
+    // This runs on many threads at once, so the buffers do not come from the memory resource of
+    // the image, which may not be thread-safe. The line has a pixel more, read (and discarded) by
+    // the last step of the window
+    auto line    = std::vector<uint32_t>(4 * (width + side));
+    auto ring    = std::vector<uint32_t>(4 * width * side);
+    auto columns = std::vector<uint64_t>(4 * width);
+
+    auto sum_row = [&](std::ptrdiff_t const y, uint32_t * sums) {
+        auto const row = base.row_ptr(static_cast<std::size_t>(_reflect(oy + y, base.sheight())));
+        for (std::size_t i = 0; i < width + side - 1; ++i) {
+            auto const [r, g, b, a] = row[_reflect(ox + x0 - radius + static_cast<std::ptrdiff_t>(i), base.swidth())];
+            line[4 * i + 0] = r * r;
+            line[4 * i + 1] = g * g;
+            line[4 * i + 2] = b * b;
+            line[4 * i + 3] = a;
+        }
+        auto acc = std::array<uint32_t, 4>{};
+        for (std::size_t i = 0; i < side; ++i) {
+            for (auto c = 0; c < 4; ++c) {
+                acc[c] += line[4 * i + c];
             }
-            auto const [prev_r, prev_g, prev_b, prev_a] = sum_sq_column(x + x0 - radius - 1, y + y0);
-            auto const [next_r, next_g, next_b, next_a] = sum_sq_column(x + x0 + radius, y + y0);
-            x_r += next_r - prev_r;
-            x_g += next_g - prev_g;
-            x_b += next_b - prev_b;
-            x_a += next_a - prev_a;
-        }
-        ++y;
-        if (y >= output.sheight()) {
+        }
+        for (std::size_t x = 0; x < width; ++x) {
+            for (auto c = 0; c < 4; ++c) {
+                sums[4 * x + c] = acc[c];
+                acc[c] += line[4 * (x + side) + c] - line[4 * x + c];
+            }
+        }
+    };
+
+    auto add_to_columns = [&](uint32_t const * sums) {
+        for (std::size_t i = 0; i < 4 * width; ++i) {
+            columns[i] += sums[i];
+        }
+    };
+
+    // the window of the first row
+    for (std::size_t i = 0; i < side; ++i) {
+        auto const slot = ring.data() + 4 * width * i;
+        sum_row(y0 - radius + static_cast<std::ptrdiff_t>(i), slot);
+        add_to_columns(slot);
+    }
+
+    for (std::size_t y = 0; y < output.height(); ++y) {
+        auto pixel = output.base().get_pixel_iterator(x0, y0 + static_cast<std::ptrdiff_t>(y));
+        for (std::size_t x = 0; x < width; ++x, ++pixel) {
+            auto const sum = columns.data() + 4 * x;
+            *pixel = rgba{
+                static_cast<uint8_t>(std::sqrt(static_cast<double>(sum[0])) * sqrt_norm_factor),
+                static_cast<uint8_t>(std::sqrt(static_cast<double>(sum[1])) * sqrt_norm_factor),
+                static_cast<uint8_t>(std::sqrt(static_cast<double>(sum[2])) * sqrt_norm_factor),
+                static_cast<uint8_t>(static_cast<double>(sum[3]) * sqrt_norm_factor * sqrt_norm_factor)
+            };
+        }
+        if (y + 1 == output.height()) {
             break;
         }
-        auto const [prev_r, prev_g, prev_b, prev_a] = sum_sq_row(x0, y + y0 - radius - 1);
-        auto const [next_r, next_g, next_b, next_a] = sum_sq_row(x0, y + y0 + radius);
-        r += next_r - prev_r;
-        g += next_g - prev_g;
-        b += next_b - prev_b;
-        a += next_a - prev_a;
+        // the row leaving the window and the one entering it share the slot
+        auto const slot = ring.data() + 4 * width * (y % side);
+        for (std::size_t i = 0; i < 4 * width; ++i) {
+            columns[i] -= slot[i];
+        }
+        sum_row(y0 + static_cast<std::ptrdiff_t>(y + side - radius), slot);
+        add_to_columns(slot);
+    }
+}
+
+/// The radii of three box filters whose composition approximates a gaussian of deviation `sigma`
+auto _gaussian_box_radii(double const sigma) noexcept
+    -> std::array<std::size_t, 3>
+{
+    // the variance of a box of width `w` is `(w² - 1) / 12`: the widths are the two odd numbers
+    // around the ideal one, mixed to give the total variance `sigma²`
+    constexpr auto n = 3;
+    auto const ideal = std::sqrt(12 * sigma * sigma / n + 1);
+    auto lower = static_cast<std::size_t>(ideal);
+    if (lower % 2 == 0) {
+        --lower;
+    }
+    auto const l = static_cast<double>(lower);
+    auto const m = std::lround((12 * sigma * sigma - n * l * l - 4 * n * l - 3 * n) / (-4 * l - 4));
+
+    auto radii = std::array<std::size_t, 3>{};
+    for (auto i = 0; i < n; ++i) {
+        radii[i] = ((i < m ? lower : lower + 2) - 1) / 2;
+    }
+    return radii;
+}
+
+/// Averages each window of `2 * radius + 1` elements of `in`, which are `stride` apart, for
+/// `count` consecutive windows; `count * stride` values are written in `out`
+void _box_pass(float const * in, float * out, std::size_t const count, std::size_t const stride, std::size_t const radius)
+{
+    auto const side = 2 * radius + 1;
+    auto const norm = 1.f / static_cast<float>(side);
+    auto acc = std::vector<double>(stride);
+    for (std::size_t i = 0; i < side; ++i) {
+        for (std::size_t c = 0; c < stride; ++c) {
+            acc[c] += in[i * stride + c];
+        }
+    }
+    for (std::size_t i = 0; i < count; ++i) {
+        for (std::size_t c = 0; c < stride; ++c) {
+            out[i * stride + c] = static_cast<float>(acc[c]) * norm;
+            if (i + 1 < count) {
+                acc[c] += in[(i + side) * stride + c] - in[i * stride + c];
+            }
+        }
     }
 }
 
@@ -193,41 +256,298 @@ void _blur_w_policy_monoarg_impl(Effect params, EffectImpl effect_impl, viewport
 {
     auto const [radius] = params;
 
-    auto const base_img = result.base();
+    auto const base_img = image{result.base(), result.base().get_allocator()};
+
+    result.add_damage({0, 0, result.swidth(), result.sheight()});
+
+    // the rows are split in strips, processed by the threads of the default executor
+    auto const max_threads = static_cast<size_t>(std::max<int16_t>(threads, 0));
+    spl::parallel_for(result.height(), [&](size_t const from, size_t const to) {
+        auto output = viewport{result, 0, static_cast<int_fast32_t>(from), result.width(), to - from};
+        effect_impl(radius, output, image_view{base_img});
+    }, max_threads);
+}
+
+void blur(std::in_place_t, effects::triangular params, viewport result, int16_t threads)
+{
+    _blur_w_policy_monoarg_impl(params, _triangular_blur, result, threads);
+}
+
+void blur(std::in_place_t, effects::box params, viewport result, int16_t threads)
+{
+    _blur_w_policy_monoarg_impl(params, _box_blur, result, threads);
+}
+
+/// Rounds a value to a channel, saturating; negative values and NaN become 0
+auto _to_channel(float const v) noexcept
+    -> uint8_t
+{
+    // the sums of the passes can cancel out to slightly negative values, and their root to NaN
+    return static_cast<uint8_t>(v > 0.f ? std::min(v + 0.5f, 255.f) : 0.f);
+}
+
+void blur(std::in_place_t, effects::gaussian params, viewport result, int16_t threads)
+{
+    if (params.sigma <= 0 or result.width() == 0 or result.height() == 0) {
+        return;
+    }
+    result.add_damage({0, 0, result.swidth(), result.sheight()});
+    auto const radii  = _gaussian_box_radii(params.sigma);
+    auto const margin = radii[0] + radii[1] + radii[2];
+    auto const width  = result.width();
+    auto const height = result.height();
+    auto const max_threads = static_cast<size_t>(std::max<int16_t>(threads, 0));
+    auto const [x0, y0] = result.offset();
+    auto & base = result.base();
+
+    // As in the box blur the squares of the channels are averaged. The rows are read `margin`
+    // pixels beyond the viewport (reflected at the borders of the image) and every pass shrinks
+    // them: three horizontal passes give `width` columns, three vertical ones `height` rows.
+    auto const rows = height + 2 * margin;
+    // only the shared buffer, made here, comes from the memory resource of the image: the threads
+    // allocate their own with the global one, as the former may not be thread-safe
+    auto buffer = std::pmr::vector<float>(4 * width * rows, base.get_allocator().resource());
+    spl::parallel_for(rows, [&](size_t const from, size_t const to) {
+        auto line    = std::vector<float>(4 * (width + 2 * margin));
+        auto scratch = std::vector<float>(line.size());
+        for (auto y = from; y < to; ++y) {
+            auto const src = base.row_ptr(static_cast<size_t>(
+                _reflect(y0 + static_cast<std::ptrdiff_t>(y) - static_cast<std::ptrdiff_t>(margin), base.sheight())
+            ));
+            for (size_t i = 0; i < width + 2 * margin; ++i) {
+                auto const x = x0 + static_cast<std::ptrdiff_t>(i) - static_cast<std::ptrdiff_t>(margin);
+                auto const [r, g, b, a] = src[_reflect(x, base.swidth())];
+                line[4 * i + 0] = static_cast<float>(r * r);
+                line[4 * i + 1] = static_cast<float>(g * g);
+                line[4 * i + 2] = static_cast<float>(b * b);
+                line[4 * i + 3] = static_cast<float>(a);
+            }
+            auto size = width + 2 * margin;
+            _box_pass(line.data(), scratch.data(), size - 2 * radii[0], 4, radii[0]);
+            size -= 2 * radii[0];
+            _box_pass(scratch.data(), line.data(), size - 2 * radii[1], 4, radii[1]);
+            size -= 2 * radii[1];
+            _box_pass(line.data(), buffer.data() + 4 * width * y, width, 4, radii[2]);
+        }
+    }, max_threads);
+
+    // the columns are split in strips, each strip goes down the rows with running sums
+    spl::parallel_for(width, [&](size_t const from, size_t const to) {
+        auto const stride = 4 * width;
+        auto const count  = 4 * (to - from);
+        auto strip   = std::vector<float>(count * rows);
+        auto scratch = std::vector<float>(strip.size());
+        for (size_t y = 0; y < rows; ++y) {
+            std::ranges::copy_n(buffer.data() + y * stride + 4 * from, count, strip.data() + y * count);
+        }
+        auto size = rows;
+        _box_pass(strip.data(), scratch.data(), size - 2 * radii[0], count, radii[0]);
+        size -= 2 * radii[0];
+        _box_pass(scratch.data(), strip.data(), size - 2 * radii[1], count, radii[1]);
+        size -= 2 * radii[1];
+        _box_pass(strip.data(), scratch.data(), height, count, radii[2]);
 
-    if (threads == 1) {
-        effect_impl(radius, result, base_img);
-    } else {
-        if (threads <= 0) {
-            threads = std::thread::hardware_concurrency();
+        for (size_t y = 0; y < height; ++y) {
+            auto pixel = base.get_pixel_iterator(x0 + static_cast<std::ptrdiff_t>(from), y0 + static_cast<std::ptrdiff_t>(y));
+            auto const * sum = scratch.data() + y * count;
+            for (auto x = from; x < to; ++x, ++pixel, sum += 4) {
+                *pixel = rgba{
+                    _to_channel(std::sqrt(sum[0])), _to_channel(std::sqrt(sum[1])), _to_channel(std::sqrt(sum[2])),
+                    _to_channel(sum[3])
+                };
+            }
         }
+    }, max_threads);
+}
 
-        auto const num_threads = std::min<uint16_t>(threads, std::thread::hardware_concurrency());
-        auto const view_height = result.height() / num_threads;
-        auto const remaining = result.height() % num_threads;
+/// A buffer of pixels with float channels: the squares of red, green and blue, and alpha
+struct _float_plane
+{
+    _float_plane(std::size_t const w, std::size_t const h, std::pmr::memory_resource * resource)
+        : width{w}, height{h}, data(4 * w * h, resource) {}
+
+    std::size_t width;
+    std::size_t height;
+    std::pmr::vector<float> data;
+};
 
-        auto workers = std::vector<std::jthread>{};
-        workers.reserve(num_threads);
+/// The weighted pixels read by a resampling kernel, as offsets from a base pixel of the source
+using _stencil = std::vector<std::tuple<std::ptrdiff_t, std::ptrdiff_t, float>>;
 
-        for (auto i = 0ul; i < num_threads; ++i) {
-            auto const start_px = static_cast<int_fast32_t>(view_height * i);
-            auto output = spl::graphics::viewport{result, 0, start_px, result.width(), view_height};
-            workers.emplace_back(effect_impl, radius, output, image_view{base_img});
+/// Adds to `taps` the bilinear interpolation in `(u, v)` with weight `weight`; the position is in
+/// pixels from the top left corner of the base pixel
+void _add_bilinear(_stencil & taps, float u, float v, float const weight)
+{
+    u -= 0.5f;
+    v -= 0.5f;
+    auto const x  = std::floor(u);
+    auto const y  = std::floor(v);
+    auto const tx = u - x;
+    auto const ty = v - y;
+    for (auto const & [dx, dy, w] : {
+        std::tuple{0, 0, (1 - tx) * (1 - ty)}, {1, 0, tx * (1 - ty)}, {0, 1, (1 - tx) * ty}, {1, 1, tx * ty}
+    }) {
+        if (w == 0) {
+            continue;
+        }
+        auto const tap_x = static_cast<std::ptrdiff_t>(x) + dx;
+        auto const tap_y = static_cast<std::ptrdiff_t>(y) + dy;
+        auto const same = [=](auto const & tap) { return std::get<0>(tap) == tap_x and std::get<1>(tap) == tap_y; };
+        if (auto const it = std::ranges::find_if(taps, same); it != taps.end()) {
+            std::get<2>(*it) += w * weight;
+        } else {
+            taps.emplace_back(tap_x, tap_y, w * weight);
         }
-        effect_impl(radius, viewport{
-            result, 0, static_cast<int_fast32_t>(view_height * num_threads), result.width(), remaining
-        }, base_img);
     }
 }
 
-void blur(std::in_place_t, effects::triangular params, viewport result, int16_t threads)
+auto _to_float_plane(viewport const & v, std::size_t const max_threads)
+    -> _float_plane
 {
-    _blur_w_policy_monoarg_impl(params, _triangular_blur, result, threads);
+    auto plane = _float_plane{v.width(), v.height(), v.base().get_allocator().resource()};
+    spl::parallel_for(v.height(), [&](size_t const from, size_t const to) {
+        for (auto y = from; y < to; ++y) {
+            auto out = plane.data.data() + 4 * y * v.width();
+            for (auto const [r, g, b, a] : v.row(y)) {
+                *out++ = static_cast<float>(r * r);
+                *out++ = static_cast<float>(g * g);
+                *out++ = static_cast<float>(b * b);
+                *out++ = static_cast<float>(a);
+            }
+        }
+    }, max_threads);
+    return plane;
 }
 
-void blur(std::in_place_t, effects::box params, viewport result, int16_t threads)
+/// Fills each pixel of `dst` with the weighted sum of the pixels of `src` given by a stencil,
+/// clamping at the borders; the plane is halved or doubled
+///
+/// Halving, the base pixel of `(x, y)` is `(2x, 2y)` and `stencils` has one element; doubling it is
+/// `(x / 2, y / 2)` and the four stencils are for odd and even `x` and `y`, in this order.
+void _resample(_float_plane const & src, _float_plane & dst, std::span<_stencil const> stencils, std::size_t const max_threads)
 {
-    _blur_w_policy_monoarg_impl(params, _box_blur, result, threads);
+    auto const doubling = stencils.size() == 4;
+    auto const max_x = static_cast<std::ptrdiff_t>(src.width) - 1;
+    auto const max_y = static_cast<std::ptrdiff_t>(src.height) - 1;
+    spl::parallel_for(dst.height, [&](size_t const from, size_t const to) {
+        for (auto y = from; y < to; ++y) {
+            auto out = dst.data.data() + 4 * y * dst.width;
+            for (std::size_t x = 0; x < dst.width; ++x, out += 4) {
+                auto const base_x = static_cast<std::ptrdiff_t>(doubling ? x / 2 : 2 * x);
+                auto const base_y = static_cast<std::ptrdiff_t>(doubling ? y / 2 : 2 * y);
+                auto const & taps = stencils[doubling ? x % 2 + 2 * (y % 2) : 0];
+
+                auto sum = std::array<float, 4>{};
+                for (auto const & [dx, dy, weight] : taps) {
+                    auto const sx = static_cast<std::size_t>(std::clamp<std::ptrdiff_t>(base_x + dx, 0, max_x));
+                    auto const sy = static_cast<std::size_t>(std::clamp<std::ptrdiff_t>(base_y + dy, 0, max_y));
+                    auto const in = src.data.data() + 4 * (sy * src.width + sx);
+                    for (auto c = 0; c < 4; ++c) {
+                        sum[c] += in[c] * weight;
+                    }
+                }
+                std::ranges::copy(sum, out);
+            }
+        }
+    }, max_threads);
+}
+
+/// The dual filter blur of `plane`, at its resolution
+auto _kawase(_float_plane plane, int_fast32_t iterations, float const offset, std::size_t const max_threads)
+    -> _float_plane
+{
+    // Halving, the center of the pixel is in the corner of the base pixel and the samples are
+    // `offset` pixels away along the diagonals. Doubling, it is a quarter of pixel from the center
+    // of the base pixel, and eight samples are taken on a rhombus around it.
+    auto down = std::array<_stencil, 1>{};
+    _add_bilinear(down[0], 1, 1, 4.f / 8);
+    for (auto const & [dx, dy] : {std::pair{-1, -1}, {1, -1}, {-1, 1}, {1, 1}}) {
+        _add_bilinear(down[0], 1 + static_cast<float>(dx) * offset, 1 + static_cast<float>(dy) * offset, 1.f / 8);
+    }
+    auto up = std::array<_stencil, 4>{};
+    for (auto phase = 0; phase < 4; ++phase) {
+        auto const u = phase % 2 == 0 ? 0.25f : 0.75f;
+        auto const v = phase / 2 == 0 ? 0.25f : 0.75f;
+        for (auto const & [dx, dy, weight] : {
+            std::tuple{-2, 0, 1}, {2, 0, 1}, {0, -2, 1}, {0, 2, 1}, {-1, -1, 2}, {1, -1, 2}, {-1, 1, 2}, {1, 1, 2}
+        }) {
+            _add_bilinear(
+                up[phase], u + static_cast<float>(dx) * offset / 2, v + static_cast<float>(dy) * offset / 2,
+                static_cast<float>(weight) / 12
+            );
+        }
+    }
+
+    auto chain = std::vector<_float_plane>{};
+    chain.push_back(std::move(plane));
+    for (; iterations > 0 and (chain.back().width > 1 or chain.back().height > 1); --iterations) {
+        auto const & last = chain.back();
+        auto half = _float_plane{(last.width + 1) / 2, (last.height + 1) / 2, last.data.get_allocator().resource()};
+        _resample(last, half, down, max_threads);
+        chain.push_back(std::move(half));
+    }
+    for (auto i = chain.size() - 1; i > 0; --i) {
+        _resample(chain[i], chain[i - 1], up, max_threads);
+    }
+    return std::move(chain.front());
+}
+
+void blur(std::in_place_t, effects::kawase params, viewport result, int16_t threads)
+{
+    if (params.iterations <= 0 or result.width() == 0 or result.height() == 0) {
+        return;
+    }
+    result.add_damage({0, 0, result.swidth(), result.sheight()});
+    auto const max_threads = static_cast<size_t>(std::max<int16_t>(threads, 0));
+    auto const blurred = _kawase(_to_float_plane(result, max_threads), params.iterations, params.offset, max_threads);
+
+    spl::parallel_for(result.height(), [&](size_t const from, size_t const to) {
+        for (auto y = from; y < to; ++y) {
+            auto const * in = blurred.data.data() + 4 * y * result.width();
+            for (auto & pixel : result.row(y)) {
+                pixel = rgba{_to_channel(std::sqrt(in[0])), _to_channel(std::sqrt(in[1])), _to_channel(std::sqrt(in[2])), _to_channel(in[3])};
+                in += 4;
+            }
+        }
+    }, max_threads);
+}
+
+void bloom(std::in_place_t, effects::bloom params, viewport result, int16_t threads)
+{
+    if (result.width() == 0 or result.height() == 0) {
+        return;
+    }
+    result.add_damage({0, 0, result.swidth(), result.sheight()});
+    auto const max_threads = static_cast<size_t>(std::max<int16_t>(threads, 0));
+
+    // the light above the threshold, fading in to avoid hard edges around the bright areas
+    auto bright = _to_float_plane(result, max_threads);
+    auto const threshold = static_cast<float>(params.threshold);
+    spl::parallel_for(result.width() * result.height(), [&](size_t const from, size_t const to) {
+        for (auto i = from; i < to; ++i) {
+            auto const px = bright.data.data() + 4 * i;
+            auto const brightness = std::sqrt(std::max({px[0], px[1], px[2]}));
+            auto const factor = brightness > threshold ? (brightness - threshold) / brightness : 0.f;
+            px[0] *= factor;
+            px[1] *= factor;
+            px[2] *= factor;
+        }
+    }, max_threads);
+    auto const glow = _kawase(std::move(bright), params.iterations, 1.f, max_threads);
+
+    // the glow is added as light, to the squared channels
+    spl::parallel_for(result.height(), [&](size_t const from, size_t const to) {
+        for (auto y = from; y < to; ++y) {
+            auto const * in = glow.data.data() + 4 * y * result.width();
+            for (auto & pixel : result.row(y)) {
+                auto add = [&](uint8_t const c, float const light) {
+                    return _to_channel(std::sqrt(static_cast<float>(c * c) + params.intensity * light));
+                };
+                pixel = rgba{add(pixel.r, in[0]), add(pixel.g, in[1]), add(pixel.b, in[2]), pixel.a};
+                in += 4;
+            }
+        }
+    }, max_threads);
 }
 
 } // namespace spl::graphics
@@ -0,0 +1,195 @@
+/**
+ * @author      : rbrugo, momokrono
+ * @file        : executor
+ * @created     : Saturday Oct 17, 2026 17:02:48 CEST
+ * @license     : MIT
+ */
+
+#include "spl/executor.hpp"
+
+#include <algorithm>
+#include <exception>
+#include <utility>
+
+namespace spl
+{
+
+namespace
+{
+// the pool the current thread belongs to, if any, and the index of its queue
+thread_local thread_pool const * current_pool = nullptr;
+thread_local std::size_t current_queue = 0;
+
+std::atomic<executor *> user_executor = nullptr;
+} // namespace
+
+thread_pool::thread_pool(std::size_t threads)
+{
+    threads = std::max<std::size_t>(threads, 1);
+    _queues.reserve(threads);
+    for (std::size_t i = 0; i < threads; ++i) {
+        _queues.push_back(std::make_unique<queue>());
+    }
+    _workers.reserve(threads);
+    for (std::size_t i = 0; i < threads; ++i) {
+        _workers.emplace_back([this, i](std::stop_token stop) { _run(stop, i); });
+    }
+}
+
+thread_pool::~thread_pool() noexcept
+{
+    for (auto & worker : _workers) {
+        worker.request_stop();
+    }
+    _workers.clear();
+}
+
+void thread_pool::submit(std::function<void()> task)
+{
+    auto const index = current_pool == this
+                     ? current_queue
+                     : _next_queue.fetch_add(1, std::memory_order_relaxed) % _queues.size();
+    // counted before it can be popped, or a worker could take it and underflow the counter
+    {
+        auto const lock = std::scoped_lock{_sleep_mutex};
+        ++_pending;
+    }
+    try {
+        auto & q = *_queues[index];
+        auto const lock = std::scoped_lock{q.mutex};
+        q.tasks.push_back(std::move(task));
+    } catch (...) {
+        --_pending;
+        throw;
+    }
+    _wake.notify_one();
+}
+
+auto thread_pool::_pop(std::size_t const index)
+    -> std::function<void()>
+{
+    // the newest task of the own queue, which is likely still in cache, otherwise the oldest of
+    // another queue
+    auto task = std::function<void()>{};
+    for (std::size_t i = 0; i < _queues.size() and not task; ++i) {
+        auto & q = *_queues[(index + i) % _queues.size()];
+        auto const lock = std::scoped_lock{q.mutex};
+        if (q.tasks.empty()) {
+            continue;
+        }
+        if (i == 0) {
+            task = std::move(q.tasks.back());
+            q.tasks.pop_back();
+        } else {
+            task = std::move(q.tasks.front());
+            q.tasks.pop_front();
+        }
+    }
+    if (task) {
+        --_pending;
+    }
+    return task;
+}
+
+void thread_pool::_run(std::stop_token stop, std::size_t const index) noexcept
+{
+    current_pool  = this;
+    current_queue = index;
+    while (true) {
+        if (auto task = _pop(index)) {
+            task();
+            continue;
+        }
+        auto lock = std::unique_lock{_sleep_mutex};
+        _wake.wait(lock, stop, [this] { return _pending > 0; });
+        if (stop.stop_requested() and _pending == 0) {
+            return;
+        }
+    }
+}
+
+auto default_executor()
+    -> executor &
+{
+    if (auto const ex = user_executor.load(std::memory_order_acquire)) {
+        return *ex;
+    }
+    static auto pool = thread_pool{};
+    return pool;
+}
+
+void set_default_executor(executor * ex) noexcept
+{
+    user_executor.store(ex, std::memory_order_release);
+}
+
+void parallel_for(
+    std::size_t const n, std::function<void(std::size_t, std::size_t)> const & body,
+    std::size_t max_threads, executor & ex
+)
+{
+    if (max_threads == 0) {
+        max_threads = ex.concurrency() + 1;
+    }
+    auto const threads = std::min(max_threads, n);
+    if (threads <= 1) {
+        if (n > 0) {
+            body(0, n);
+        }
+        return;
+    }
+
+    // Some chunks more than the threads, to balance uneven ones. The helpers can start after the
+    // caller returned, so the state is shared; they touch `body` only if they find a chunk left.
+    struct state
+    {
+        std::function<void(std::size_t, std::size_t)> const * body;
+        std::size_t n;
+        std::size_t chunks;
+        std::atomic<std::size_t> next{0};
+        std::atomic<std::size_t> done{0};
+        std::mutex mutex;
+        std::condition_variable finished;
+        std::exception_ptr error;
+    };
+    auto const shared = std::make_shared<state>();
+    shared->body   = &body;
+    shared->n      = n;
+    shared->chunks = std::min(n, threads * 4);
+
+    auto const run_chunks = [](state & s) noexcept {
+        for (auto c = s.next++; c < s.chunks; c = s.next++) {
+            try {
+                (*s.body)(s.n * c / s.chunks, s.n * (c + 1) / s.chunks);
+            } catch (...) {
+                auto const lock = std::scoped_lock{s.mutex};
+                if (not s.error) {
+                    s.error = std::current_exception();
+                }
+            }
+            if (++s.done == s.chunks) {
+                auto const lock = std::scoped_lock{s.mutex};
+                s.finished.notify_all();
+            }
+        }
+    };
+
+    // if a helper cannot be submitted, its chunks are left to the others and to the caller
+    try {
+        for (std::size_t i = 1; i < threads; ++i) {
+            ex.submit([shared, run_chunks] { run_chunks(*shared); });
+        }
+    } catch (...) {
+    }
+    run_chunks(*shared);
+
+    auto lock = std::unique_lock{shared->mutex};
+    shared->finished.wait(lock, [&s = *shared] { return s.done == s.chunks; });
+    // a helper may still hold the state, the exception must not be released by it
+    if (auto const error = std::exchange(shared->error, nullptr)) {
+        lock.unlock();
+        std::rethrow_exception(error);
+    }
+}
+
+} // namespace spl
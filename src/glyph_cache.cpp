@@ -0,0 +1,194 @@
+/**
+ * @author      : rbrugo, momokrono
+ * @file        : glyph_cache
+ * @created     : Monday Oct 19, 2026 11:42:10 CEST
+ * @license     : MIT
+ */
+
+#include "spl/detail/glyph_cache.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <utility>
+
+namespace spl::detail
+{
+
+namespace
+{
+    /// Also the glyphs without pixels take a place, so that the table stays bounded
+    constexpr auto glyphs_per_page = std::size_t{4096};
+    constexpr auto min_capacity    = std::size_t{64};
+
+    constexpr
+    auto hash(glyph_key const key) noexcept
+        -> std::size_t
+    {
+        auto h = (uint64_t{static_cast<uint32_t>(key.codepoint)} << 32 | key.height_bits) * 0x9e3779b97f4a7c15ull;
+        h ^= (h >> 29) + key.shift * 0xc2b2ae3d27d4eb4full;
+        return static_cast<std::size_t>(h ^ (h >> 32));
+    }
+
+    constexpr bool empty(glyph_key const key) noexcept { return key.codepoint < 0; }
+} // namespace
+
+auto glyph_cache::_slot(glyph_key const key) const noexcept
+    -> std::size_t
+{
+    auto const mask = _table.size() - 1;
+    auto i = hash(key) & mask;
+    while (not empty(_table[i].key) and _table[i].key != key) {
+        i = (i + 1) & mask;
+    }
+    return i;
+}
+
+void glyph_cache::_place(entry const & e)
+{
+    _table[_slot(e.key)] = e;
+}
+
+void glyph_cache::_rehash(std::size_t const capacity)
+{
+    auto const old = std::exchange(_table, std::vector<entry>(capacity));
+    for (auto const & e : old) {
+        if (not empty(e.key)) {
+            _place(e);
+        }
+    }
+}
+
+auto glyph_cache::find(glyph_key const key) const
+    -> std::optional<handle>
+{
+    auto lock = std::shared_lock{_mutex};
+    if (_table.empty()) {
+        return std::nullopt;
+    }
+    auto const & e = _table[_slot(key)];
+    if (empty(e.key)) {
+        return std::nullopt;
+    }
+    auto const & p = *_pages[e.page];
+    p.last_use.store(_clock.fetch_add(1, std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    auto const bitmap = glyph_bitmap{
+        p.pixels.get() + e.y * page_size + e.x, e.width, e.height, page_size, e.x_off, e.y_off
+    };
+    return handle{std::move(lock), bitmap};
+}
+
+void glyph_cache::insert(glyph_key const key, glyph_bitmap const bitmap)
+{
+    if (empty(key) or bitmap.width < 0 or bitmap.height < 0
+        or bitmap.width > page_size or bitmap.height > page_size
+        or std::max(std::abs(bitmap.x_off), std::abs(bitmap.y_off)) > INT16_MAX) {
+        return;
+    }
+
+    auto const lock = std::unique_lock{_mutex};
+    if (not _table.empty() and not empty(_table[_slot(key)].key)) {
+        return; // stored by another thread in the meantime
+    }
+    auto e = _allocate(bitmap.width, bitmap.height);
+    if (not e) {
+        return;
+    }
+    e->key   = key;
+    e->x_off = static_cast<int16_t>(bitmap.x_off);
+    e->y_off = static_cast<int16_t>(bitmap.y_off);
+    auto * const pixels = _pages[e->page]->pixels.get();
+    for (auto y = 0; y < bitmap.height; ++y) {
+        std::memcpy(pixels + (e->y + y) * page_size + e->x, bitmap.data + y * bitmap.stride, bitmap.width);
+    }
+
+    if ((_entries + 1) * 4 > _table.size() * 3) {
+        _rehash(std::max(min_capacity, _table.size() * 2));
+    }
+    _place(*e);
+    ++_entries;
+}
+
+void glyph_cache::clear()
+{
+    auto const lock = std::unique_lock{_mutex};
+    _pages.clear();
+    _table.clear();
+    _entries = 0;
+}
+
+auto glyph_cache::_allocate(int const width, int const height)
+    -> std::optional<entry>
+{
+    auto const place = [&](std::size_t const index, int const x, int const y) {
+        auto & p = *_pages[index];
+        ++p.glyphs;
+        p.last_use.store(_clock.fetch_add(1, std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        auto e = entry{};
+        e.page   = static_cast<uint16_t>(index);
+        e.x      = static_cast<uint16_t>(x);
+        e.y      = static_cast<uint16_t>(y);
+        e.width  = static_cast<int16_t>(width);
+        e.height = static_cast<int16_t>(height);
+        return e;
+    };
+    auto const try_page = [&](std::size_t const index) -> std::optional<entry> {
+        auto & p = *_pages[index];
+        if (p.glyphs >= glyphs_per_page) {
+            return std::nullopt;
+        }
+        if (width == 0 or height == 0) {
+            return place(index, 0, 0);
+        }
+        // a shelf taller than needed by half wastes too much space, better to open a new one
+        for (auto & s : p.shelves) {
+            if (height <= s.height and s.height <= height + height / 2 + 1 and s.x + width <= page_size) {
+                auto const x = std::exchange(s.x, s.x + width);
+                return place(index, x, s.y);
+            }
+        }
+        if (p.next_y + height <= page_size) {
+            p.shelves.push_back({p.next_y, height, width});
+            return place(index, 0, std::exchange(p.next_y, p.next_y + height));
+        }
+        return std::nullopt;
+    };
+
+    for (auto i = std::size_t{0}; i < _pages.size(); ++i) {
+        if (auto e = try_page(i)) {
+            return e;
+        }
+    }
+    if (_pages.size() < _max_pages) {
+        _pages.push_back(std::make_unique<page>());
+        return try_page(_pages.size() - 1);
+    }
+    if (_pages.empty()) {
+        return std::nullopt;
+    }
+    auto const oldest = std::ranges::min_element(_pages, std::less{}, [](auto const & p) {
+        return p->last_use.load(std::memory_order_relaxed);
+    });
+    auto const index = static_cast<std::size_t>(oldest - _pages.begin());
+    _evict(index);
+    return try_page(index);
+}
+
+void glyph_cache::_evict(std::size_t const page_index)
+{
+    auto & p = *_pages[page_index];
+    p.shelves.clear();
+    p.next_y = 0;
+    p.glyphs = 0;
+
+    auto const old = std::exchange(_table, std::vector<entry>(_table.size()));
+    _entries = 0;
+    for (auto const & e : old) {
+        if (not empty(e.key) and e.page != page_index) {
+            _place(e);
+            ++_entries;
+        }
+    }
+}
+
+} // namespace spl::detail
@@ -0,0 +1,184 @@
+/**
+ * @author      : rbrugo, momokrono
+ * @file        : group
+ * @created     : Saturday Oct 17, 2026 15:41:27 CEST
+ * @license     : MIT
+ */
+
+#include "spl/group.hpp"
+#include "spl/executor.hpp"
+
+#include <span>
+
+namespace spl::graphics
+{
+
+/// The objects of a group and of the nested ones, in drawing order
+struct group::flat_view
+{
+    static constexpr auto no_parent = static_cast<size_t>(-1);
+
+    struct frame
+    {
+        size_t parent;  ///< the index of the containing group, or `no_parent`
+        vertex origin;  ///< relative to the containing group
+        vertex offset;  ///< relative to the viewport the outermost group is drawn on
+    };
+
+    struct item
+    {
+        any_drawable const * obj;
+        size_t frame;
+        std::optional<graphics::bounding_box> box;  ///< relative to the same viewport of `offset`
+    };
+
+    std::vector<frame> frames;
+    std::vector<item> items;
+
+    /// The viewport where the objects of a frame are drawn, the same that `group::render_on` builds
+    auto view(viewport img, size_t const frame) const
+        -> viewport
+    {
+        if (frame == no_parent) {
+            return img;
+        }
+        auto const & [parent, origin, offset] = frames[frame];
+        return viewport{view(img, parent), origin.x, origin.y};
+    }
+};
+
+void group::_flatten(flat_view & flat, size_t const parent) const
+{
+    auto const frame  = flat.frames.size();
+    auto const offset = parent == flat_view::no_parent ? _origin : flat.frames[parent].offset + _origin;
+    flat.frames.push_back({parent, _origin, offset});
+    for (auto const & obj : _buffer) {
+        if (auto const nested = obj.target<group>()) {
+            nested->_flatten(flat, frame);
+            continue;
+        }
+        auto box = obj.bounding_box();
+        if (box.has_value()) {
+            box->translate(offset.x, offset.y);
+        }
+        flat.items.push_back({std::addressof(obj), frame, box});
+    }
+}
+
+namespace
+{
+/// Draws the items splitting `img` in tiles, rendered in parallel by the default executor
+///
+/// Every item must have a bounding box
+template <typename FlatView, typename Item>
+void _render_tiled(
+    viewport img, FlatView const & flat, std::span<Item const> items, size_t const threads,
+    int_fast32_t const tile_size
+)
+{
+    auto const area = img.clip_box();
+    if (items.empty() or area.empty()) {
+        return;
+    }
+    auto const cols = (area.width()  + tile_size - 1) / tile_size;
+    auto const rows = (area.height() + tile_size - 1) / tile_size;
+
+    // the items are binned in order, so each tile draws them in the order they were pushed
+    auto bins = std::vector<std::vector<uint32_t>>(static_cast<size_t>(cols * rows));
+    for (size_t i = 0; i < items.size(); ++i) {
+        auto const box = items[i].box->intersect(area);
+        if (box.empty()) {
+            continue;
+        }
+        auto const col_from = (box.x0 - area.x0) / tile_size;
+        auto const col_to   = (box.x1 - 1 - area.x0) / tile_size;
+        auto const row_from = (box.y0 - area.y0) / tile_size;
+        auto const row_to   = (box.y1 - 1 - area.y0) / tile_size;
+        for (auto row = row_from; row <= row_to; ++row) {
+            for (auto col = col_from; col <= col_to; ++col) {
+                bins[static_cast<size_t>(row * cols + col)].push_back(static_cast<uint32_t>(i));
+            }
+        }
+    }
+
+    spl::parallel_for(bins.size(), [&](size_t const from, size_t const to) noexcept {
+        for (auto t = from; t < to; ++t) {
+            if (bins[t].empty()) {
+                continue;
+            }
+            auto const x = area.x0 + static_cast<int_fast32_t>(t % cols) * tile_size;
+            auto const y = area.y0 + static_cast<int_fast32_t>(t / cols) * tile_size;
+            auto const tile = viewport{img}.clip({x, y, x + tile_size, y + tile_size});
+            for (auto const i : bins[t]) {
+                items[i].obj->render_on(flat.view(tile, items[i].frame));
+            }
+        }
+    }, threads);
+}
+} // namespace
+
+void group::render_on(graphics::viewport img, int16_t const threads, uint16_t const tile_size) const
+{
+    if (threads == 1 or tile_size == 0) {
+        render_on(img);
+        return;
+    }
+    auto const max_threads = static_cast<size_t>(std::max<int16_t>(threads, 0));
+
+    auto flat = flat_view{};
+    _flatten(flat, flat_view::no_parent);
+    auto const items = std::span{std::as_const(flat.items)};
+
+    // the items are split in batches by the ones without a bounding box, which are drawn alone
+    auto first = size_t{0};
+    for (size_t i = 0; i <= items.size(); ++i) {
+        if (i < items.size() and items[i].box.has_value()) {
+            continue;
+        }
+        _render_tiled(img, flat, items.subspan(first, i - first), max_threads, tile_size);
+        if (i < items.size()) {
+            items[i].obj->render_on(flat.view(img, items[i].frame));
+        }
+        first = i + 1;
+    }
+}
+
+void group::render_on(
+    graphics::viewport img, graphics::bounding_box const area, int16_t const threads, uint16_t const tile_size
+) const
+{
+    img.clip(area);
+    if (img.clip_box().empty()) {
+        return;
+    }
+    if (threads != 1 and tile_size != 0) {
+        // only the tiles in the clipped area are drawn
+        render_on(img, threads, tile_size);
+        return;
+    }
+
+    auto flat = flat_view{};
+    _flatten(flat, flat_view::no_parent);
+    for (auto const & item : flat.items) {
+        if (item.box.has_value() and not item.box->intersects(img.clip_box())) {
+            continue;
+        }
+        item.obj->render_on(flat.view(img, item.frame));
+    }
+}
+
+auto group::bounding_box() const
+    -> std::optional<graphics::bounding_box>
+{
+    auto result = graphics::bounding_box{};
+    for (auto const & obj : _buffer) {
+        auto const box = obj.bounding_box();
+        if (not box.has_value()) {
+            return std::nullopt;
+        }
+        result = result.unite(*box);
+    }
+    return result.translate(_origin.x, _origin.y);
+}
+
+} // namespace spl::graphics
@@ -7,14 +7,22 @@
 
 #include "spl/image.hpp"
 #include "spl/viewport.hpp"
+#include "spl/pnm.hpp"
+#include "spl/detail/mapped_file.hpp"
+#include "spl/detail/png.hpp"
 #include "spl/detail/exceptions.hpp"
 
+#include <array>
+#include <bit>
+#include <cstring>
 #include <fstream>
-#include <fmt/core.h>
-#include <fmt/os.h>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <string_view>
 
 #ifdef SPL_FILL_MULTITHREAD
-#include <thread>
+#include "spl/executor.hpp"
 #endif // SPL_FILL_MULTITHREAD
 
 #include "stb_image_write.h"
@@ -23,13 +31,180 @@
 namespace spl::graphics
 {
 
+namespace
+{
+// The native format: a magic string, width and height as 32 bit little endian integers, then the
+// pixels as they are in memory, with straight alpha
+constexpr auto spl_magic       = std::string_view{"SPLRGBA1"};
+constexpr auto spl_header_size = std::size_t{16};
+
+constexpr auto bmp_rgb             = 0u;
+constexpr auto bmp_bitfields       = 3u;
+constexpr auto bmp_alpha_bitfields = 6u;
+constexpr auto bmp_masks_offset    = std::size_t{54};    // after the file and the info headers
+
+template <std::unsigned_integral T>
+auto read_le(std::span<std::byte const> const data) noexcept
+    -> T
+{
+    auto value = T{0};
+    for (auto i = 0u; i < sizeof(T); ++i) {
+        value |= static_cast<T>(std::to_integer<T>(data[i]) << (8 * i));
+    }
+    return value;
+}
+
+template <std::unsigned_integral T>
+void write_le(std::span<std::byte> const data, T const value) noexcept
+{
+    for (auto i = 0u; i < sizeof(T); ++i) {
+        data[i] = static_cast<std::byte>(value >> (8 * i));
+    }
+}
+
+/// An output stream buffer handing its content to a `byte_sink` whenever it is full or flushed
+class sink_buffer : public std::streambuf
+{
+public:
+    explicit sink_buffer(byte_sink const & sink) : _sink{sink} { setp(_buffer.data(), _buffer.data() + _buffer.size()); }
+
+protected:
+    auto overflow(int_type const c) -> int_type override
+    {
+        sync();
+        if (not traits_type::eq_int_type(c, traits_type::eof())) {
+            *pptr() = traits_type::to_char_type(c);
+            pbump(1);
+        }
+        return traits_type::not_eof(c);
+    }
+
+    auto sync() -> int override
+    {
+        if (pptr() != pbase()) {
+            _sink(std::as_bytes(std::span{pbase(), pptr()}));
+            setp(_buffer.data(), _buffer.data() + _buffer.size());
+        }
+        return 0;
+    }
+
+private:
+    byte_sink const & _sink;
+    std::array<char, 64 * 1024> _buffer;
+};
+
+// the pixels in an aligned row
+constexpr auto pixels_per_alignment = image::row_alignment / sizeof(rgba);
+
+auto aligned_stride(std::size_t const width) noexcept
+{
+    return (width + pixels_per_alignment - 1) / pixels_per_alignment * pixels_per_alignment;
+}
+
+/// The size of the storage for the pixels, with room to move the first row to an aligned address
+auto storage_size(std::size_t const stride, std::size_t const height, bool const aligned) noexcept
+{
+    auto const size = stride * height;
+    return aligned and size > 0 ? size + pixels_per_alignment - 1 : size;
+}
+} // namespace
+
+image::image(aligned_rows_t, index_type const w, index_type const h, rgba const fill, allocator_type const alloc) :
+    _pixels{storage_size(aligned_stride(w), h, true), fill, alloc},
+    _width{w}, _height{h}, _stride{aligned_stride(w)},
+    _aligned_rows{true}
+{
+    // all the storage is filled, there is no need to move the pixels
+    _offset = _first_aligned_pixel();
+}
+
+image::image(image const & other, allocator_type const alloc) :
+    _pixels{other._pixels, alloc},
+    _width{other._width}, _height{other._height}, _stride{other._stride},
+    _aligned_rows{other._aligned_rows},
+    _blending{other._blending},
+    _damage{other._damage}
+{
+    _realign(other._offset);
+}
+
+auto image::operator=(image const & other)
+    -> image &
+{
+    if (this != &other) {
+        _pixels       = other._pixels;
+        _width        = other._width;
+        _height       = other._height;
+        _stride       = other._stride;
+        _aligned_rows = other._aligned_rows;
+        _blending     = other._blending;
+        _damage       = other._damage;
+        _realign(other._offset);
+    }
+    return *this;
+}
+
+auto image::operator=(image && other)
+    -> image &
+{
+    // the pixels are copied in the own storage if the resources differ
+    _pixels       = std::move(other._pixels);
+    _width        = other._width;
+    _height       = other._height;
+    _stride       = other._stride;
+    _aligned_rows = other._aligned_rows;
+    _blending     = other._blending;
+    _damage       = other._damage;
+    _realign(other._offset);
+    return *this;
+}
+
+auto image::_first_aligned_pixel() const noexcept
+    -> index_type
+{
+    if (not _aligned_rows or _pixels.empty()) {
+        return 0;
+    }
+    auto const misalignment = reinterpret_cast<std::uintptr_t>(_pixels.data()) % row_alignment;
+    if (misalignment % sizeof(rgba) != 0) {
+        return 0;
+    }
+    return (row_alignment - misalignment) % row_alignment / sizeof(rgba);
+}
+
+void image::_realign(index_type const from) noexcept
+{
+    auto const to = _first_aligned_pixel();
+    if (to != from) {
+        std::memmove(_pixels.data() + to, _pixels.data() + from, sizeof(rgba) * _stride * _height);
+    }
+    _offset = to;
+}
+
+void image::_reshape(index_type const w, index_type const h)
+{
+    // the image keeps its old shape if the pixels cannot be allocated
+    auto const stride = _aligned_rows ? aligned_stride(w) : w;
+    if (h != 0 and stride > _pixels.max_size() / h) {
+        throw std::length_error{"spl::graphics::image: too many pixels"};
+    }
+    _pixels.resize(storage_size(stride, h, _aligned_rows));
+    _width  = w;
+    _height = h;
+    _stride = stride;
+    _offset = _first_aligned_pixel();
+    if (_damage) {
+        _damage = bounding_box{0, 0, _signed(w), _signed(h)};
+    }
+}
+
 auto image::get_pixel_iterator(index_type const x, index_type const y)
     -> image::iterator
 {
     if (x > _width - 1 or y > _height - 1) {
         throw spl::out_of_range{x, y, _width, _height};
     }
-    return _pixels.begin() + static_cast<ptrdiff_t>(x + y * _width);
+    return begin() + static_cast<ptrdiff_t>(x + y * _stride);
 }
 
 auto image::get_pixel_iterator(index_type const x, index_type const y) const
@@ -38,7 +213,7 @@ auto image::get_pixel_iterator(index_type const x, index_type const y) const
     if (x > _width - 1 or y > _height - 1) {
         throw spl::out_of_range{x, y, _width, _height};
     }
-    return _pixels.begin() + static_cast<ptrdiff_t>(x + y * _width);
+    return begin() + static_cast<ptrdiff_t>(x + y * _stride);
 }
 
 auto image::rows() -> spl::graphics::image_range<true, false>
@@ -64,25 +239,25 @@ auto image::columns() const -> spl::graphics::image_range<false, true>
 auto image::row(size_t const y) -> spl::graphics::row_col_range<true, false>
 {
     auto it = get_pixel_iterator(0, y);
-    return {it, _width};
+    return {it, _width, static_cast<ptrdiff_t>(_stride)};
 }
 
 auto image::row(size_t const y) const -> spl::graphics::row_col_range<true, true>
 {
     auto it = get_pixel_iterator(0, y);
-    return {it, _width};
+    return {it, _width, static_cast<ptrdiff_t>(_stride)};
 }
 
 auto image::column(size_t const x) -> spl::graphics::row_col_range<false, false>
 {
     auto it = get_pixel_iterator(x, 0);
-    return {{it, _width}, _height};
+    return {{it, _stride}, _height};
 }
 
 auto image::column(size_t const x) const -> spl::graphics::row_col_range<false, true>
 {
     auto it = get_pixel_iterator(x, 0);
-    return {{it, _width}, _height};
+    return {{it, _stride}, _height};
 }
 
 auto image::pixel(index_type const x, index_type const y) const
@@ -91,7 +266,7 @@ auto image::pixel(index_type const x, index_type const y) const
     if (x >= width() or y >= height()) {
         throw spl::out_of_range{x, y, _width, _height};
     }
-    return _pixels.at(x+y*_width);
+    return pixel_unchecked(x, y);
 }
 
 auto image::pixel(index_type const x, index_type const y)
@@ -100,7 +275,7 @@ auto image::pixel(index_type const x, index_type const y)
     if (x >= width() or y >= height()) {
         throw spl::out_of_range{x, y, _width, _height};
     }
-    return _pixels.at(x + y * _width);
+    return pixel_unchecked(x, y);
 }
 
 auto image::pixel_noexcept(index_type const x, index_type const y) const noexcept
@@ -109,7 +284,7 @@ auto image::pixel_noexcept(index_type const x, index_type const y) const noexcep
     if (x >= width() or y >= height()) {
         return image::_garbage_pixel;
     }
-    return _pixels.at(x + y * _width);
+    return pixel_unchecked(x, y);
 }
 
 auto image::pixel_noexcept(index_type const x, index_type const y) noexcept
@@ -118,141 +293,356 @@ auto image::pixel_noexcept(index_type const x, index_type const y) noexcept
     if (x >= width() or y >= height()) {
         return image::_garbage_pixel;
     }
-    return _pixels.at(x + y * _width);
+    return pixel_unchecked(x, y);
 }
 
 auto image::fill(rgba const c) & noexcept
     -> image &
 {
+    auto const value = stored_color(c, _blending);
+    add_damage({0, 0, _signed(_width), _signed(_height)});
 #ifdef SPL_FILL_MULTITHREAD
-    auto const n_threads = std::thread::hardware_concurrency();
-    auto const pix_dim = _height * _width;
-    auto const pix_per_thread = pix_dim / n_threads;
-    auto jobs = std::vector<std::jthread>();
-    jobs.reserve(n_threads);
-    for (auto i = 0u; i < n_threads; ++i) {
-        jobs.emplace_back([this](auto j, auto p, auto col) {
-            std::ranges::fill(_pixels.begin() + p * j, _pixels.begin() + p * (j + 1), col);
-        }, i, pix_per_thread, c);
-    }
-    std::ranges::fill(_pixels.begin() + pix_per_thread * n_threads, _pixels.end(), c);
+    // the chunks cannot throw, only setting up the threads can: then it is done here alone
+    try {
+        spl::parallel_for(_pixels.size(), [this, value](size_t const from, size_t const to) noexcept {
+            std::fill(_pixels.begin() + from, _pixels.begin() + to, value);
+        });
+    } catch (...) {
+        std::ranges::fill(_pixels, value);
+    }
 #else
-    std::ranges::fill(_pixels, c);
+    std::ranges::fill(_pixels, value);
 #endif // SPL_FILL_MULTITHREAD
 
     return *this;
 }
 
-bool image::save_to_file(std::string_view const filename) const
+auto image::blending(blend_mode const mode) &
+    -> image &
 {
-    if (filename.ends_with(".bmp")) {
-        return stbi_write_bmp(filename.data(), swidth(), sheight(), 4, raw_data()) == 1;
+    if ((mode == blend_mode::premultiplied) != premultiplied()) {
+        throw spl::invalid_argument{"'image::blending' cannot switch from or to premultiplied alpha,"
+                                    " use 'image::premultiply' or 'image::unpremultiply' instead"};
     }
-    if (filename.ends_with(".png")) {
-        return stbi_write_png(filename.data(), swidth(), sheight(), 4, raw_data(), 0) == 1;
+    _blending = mode;
+    return *this;
+}
+
+auto image::premultiply() & noexcept
+    -> image &
+{
+    if (not premultiplied()) {
+        std::ranges::transform(_pixels, _pixels.begin(), [](rgba const c) {
+            return stored_color(c, blend_mode::premultiplied);
+        });
+        _blending = blend_mode::premultiplied;
+    }
+    return *this;
+}
+
+auto image::unpremultiply() & noexcept
+    -> image &
+{
+    if (premultiplied()) {
+        std::ranges::transform(_pixels, _pixels.begin(), [](rgba const c) {
+            return graphics::unpremultiply(std::bit_cast<rgba_premul>(c));
+        });
+        _blending = default_blend_mode;
     }
-    if (filename.ends_with(".jpg")) {
-        return stbi_write_jpg(filename.data(), swidth(), sheight(), 4, raw_data(), 90) == 1;
+    return *this;
+}
+
+bool image::save_to_file(std::string_view const filename, save_options const & options) const
+{
+    auto const format = filename.ends_with(".png") ? image_format::png
+                      : filename.ends_with(".jpg") ? image_format::jpg
+                      : filename.ends_with(".bmp") ? image_format::bmp
+                      : filename.ends_with(".ppm") ? image_format::ppm
+                      : filename.ends_with(".pam") ? image_format::pam
+                      : filename.ends_with(".spl") ? image_format::spl
+                      : std::optional<image_format>{};
+    if (not format) {
+        return false;
     }
-    if (filename.ends_with(".ppm")) {
-        auto sink = fmt::output_file(filename.data());
-        sink.print("P3\n{} {}\n255\n", width(), height());
-        for (size_t j = 0; j < height(); ++j) {
-            for (size_t i = 0; i < width(); ++i) {
-                auto const [r, g, b, a] = pixel(i, j);
-                sink.print("{} {} {}\n", a * r / 255, a * g / 255, a * b / 255);
+    // the encoders write as they go: the file is written aside and moved in place once complete,
+    // so that a failure does not leave a truncated file
+    auto const path = std::filesystem::path{filename};
+    auto partial = path;
+    partial += ".partial";
+    auto ec = std::error_code{};
+    {
+        auto out = std::ofstream{partial, std::ios_base::binary};
+        auto const ok = encode(*format, out, options) and out.flush();
+        out.close();
+        if (ok and out) {
+            std::filesystem::rename(partial, path, ec);
+            if (not ec) {
+                return true;
             }
-            sink.print("\n");
         }
+    }
+    std::filesystem::remove(partial, ec);
+    return false;
+}
 
-        return true;
+auto image::encode(image_format const format, save_options const & options) const
+    -> std::vector<std::byte>
+{
+    auto result = std::vector<std::byte>{};
+    auto const append = [&result](std::span<std::byte const> const data) {
+        result.insert(result.end(), data.begin(), data.end());
+    };
+    if (not encode(format, append, options)) {
+        result.clear();
     }
-#if 0
-    if (filename.ends_with(".pam")) {
-        auto sink = std::ofstream{filename.data()};
-        if (not sink) {
-            return false;
-        }
+    return result;
+}
 
-        fmt::print(sink, "P7\nWIDTH {}\nHEIGHT {}\nDEPTH 4\nMAXVAL 255\nTUPLTYPE RGB_ALPHA\nENDHDR\n", width(), height());
+bool image::encode(image_format const format, std::ostream & out, save_options const & options) const
+{
+    auto const write = [&out](std::span<std::byte const> const data) {
+        out.write(reinterpret_cast<char const *>(data.data()), static_cast<std::streamsize>(data.size()));
+    };
+    return encode(format, write, options) and out.good();
+}
 
-        for (size_t j = 0; j < height(); ++j) {
-            for (size_t i = 0; i < width(); ++i) {
-                auto const [r, g, b, a] = pixel(i, j);
-                fmt::print(sink, "{} {} {} {}\n", r, g, b, a);
-            }
-        }
+bool image::encode(image_format const format, byte_sink const & write, save_options const & options) const
+{
+    if (premultiplied()) {
+        auto straight = *this;
+        return straight.unpremultiply().encode(format, write, options);
+    }
+    if (_stride != _width and (format == image_format::bmp or format == image_format::jpg)) {
+        // stb writes these only from packed rows
+        return image{image_view{*this}}.encode(format, write, options);
+    }
+    if (empty()) {
+        return false;
+    }
 
+    // stb writes a few bytes at a time, they are collected in larger blocks
+    auto const stb_write = [](void * context, void * data, int const size) {
+        static_cast<sink_buffer *>(context)->sputn(static_cast<char const *>(data), size);
+    };
+    switch (format) {
+    case image_format::png:
+        return spl::detail::encode_png(image_view{*this}, options, write);
+    case image_format::jpg: {
+        auto const quality = std::clamp<int>(options.jpeg_quality, 1, 100);
+        auto buffer = sink_buffer{write};
+        auto const ok = stbi_write_jpg_to_func(stb_write, &buffer, swidth(), sheight(), 4, raw_data(), quality) == 1;
+        buffer.pubsync();
+        return ok;
+    }
+    case image_format::bmp: {
+        auto buffer = sink_buffer{write};
+        auto const ok = stbi_write_bmp_to_func(stb_write, &buffer, swidth(), sheight(), 4, raw_data()) == 1;
+        buffer.pubsync();
+        return ok;
+    }
+    case image_format::ppm:
+    case image_format::pam: {
+        auto buffer = sink_buffer{write};
+        auto stream = std::ostream{&buffer};
+        auto out = pnm_writer{stream, width(), height(), format == image_format::ppm ? pnm_format::ppm : pnm_format::pam};
+        for (size_t y = 0; out and y < height(); ++y) {
+            out.write_row({row_ptr(y), width()});
+        }
+        return out.close();
+    }
+    case image_format::spl: {
+        auto header = std::array<std::byte, spl_header_size>{};
+        std::ranges::copy(std::as_bytes(std::span{spl_magic}), header.begin());
+        write_le(std::span{header}.subspan(8), static_cast<uint32_t>(_width));
+        write_le(std::span{header}.subspan(12), static_cast<uint32_t>(_height));
+        write(header);
+        for (size_t y = 0; y < _height; ++y) {
+            write(std::as_bytes(std::span{row_ptr(y), _width}));
+        }
         return true;
     }
-#endif
+    }
     return false;
 }
 
 auto image::load_from_file(std::filesystem::path const & filename)
     -> load_status
 {
-    struct stb_clear { void operator()(uint8_t * ptr) { if (ptr) { stbi_image_free(ptr); } } };
-    _pixels.clear();
-    _width  = 0;
-    _height = 0;
+    _reshape(0, 0);
     if (not std::filesystem::exists(filename)) {
         return load_status::file_not_found;
     }
-    if (filename.extension() == ".ppm") {
-        return load_ppm(filename);
+    // the uncompressed formats are decoded straight from the mapping into the pixels
+    auto const file = spl::detail::mapped_file::open(filename);
+    if (not file) {
+        return load_status::failure;
+    }
+    return decode(file->bytes());
+}
+
+auto image::decode(std::span<std::byte const> const data)
+    -> load_status
+{
+    _reshape(0, 0);
+    auto const starts_with = [data](std::string_view const magic) {
+        return data.size() >= magic.size() and std::ranges::equal(data.first(magic.size()), std::as_bytes(std::span{magic}));
+    };
+    if (starts_with(spl_magic)) {
+        return _decode_spl(data);
+    }
+    if (starts_with("BM")) {
+        return _decode_bmp(data);
+    }
+    if (data.size() >= 2 and data[0] == std::byte{'P'} and std::to_integer<char>(data[1]) >= '1' and std::to_integer<char>(data[1]) <= '7') {
+        return _decode_pnm(data);
     }
+    return _decode_stb(data);
+}
+
+auto image::_decode_stb(std::span<std::byte const> const data)
+    -> load_status
+{
+    struct stb_clear { void operator()(uint8_t * ptr) { if (ptr) { stbi_image_free(ptr); } } };
     auto width = 0;
     auto height = 0;
     auto channels = 0;
-    auto ptr = std::unique_ptr<uint8_t, stb_clear>{
-        stbi_load(filename.c_str(), &width, &height, &channels, STBI_rgb_alpha)
-    };
+    if (data.size() > static_cast<size_t>(std::numeric_limits<int>::max())) {
+        return load_status::failure;
+    }
+    auto ptr = std::unique_ptr<uint8_t, stb_clear>{stbi_load_from_memory(
+        reinterpret_cast<stbi_uc const *>(data.data()), static_cast<int>(data.size()), &width, &height, &channels, STBI_rgb_alpha
+    )};
 
     if (not ptr) {
         return load_status::failure;
     }
 
-    _pixels.resize(static_cast<size_t>(width * height));
-    std::ranges::copy_n(ptr.get(), width * height * 4, reinterpret_cast<uint8_t *>(_pixels.data()));
-    _width  = static_cast<size_t>(width);
-    _height = static_cast<size_t>(height);
+    _reshape(static_cast<size_t>(width), static_cast<size_t>(height));
+    for (size_t y = 0; y < _height; ++y) {
+        std::memcpy(row_ptr(y), ptr.get() + 4 * _width * y, 4 * _width);
+    }
+    _premultiply_loaded();
 
     return load_status::success;
 }
 
-auto image::load_ppm(std::filesystem::path const & filename)
+auto image::_decode_pnm(std::span<std::byte const> const data)
     -> load_status
 {
-    auto in = std::ifstream{filename};
-    if (not in) {
-        return load_status::failure;
+    // the rows are copied once, straight into the pixels
+    auto in = pnm_reader{data};
+    if (in.status() != load_status::success) {
+        return in.status();
+    }
+    _reshape(in.width(), in.height());
+    for (size_t y = 0; y < _height; ++y) {
+        if (not in.read_row({row_ptr(y), _width})) {
+            _reshape(0, 0);
+            return load_status::failure;
+        }
+    }
+    if (in.has_alpha()) {
+        _premultiply_loaded();
+    }
+    return load_status::success;
+}
+
+auto image::_decode_bmp(std::span<std::byte const> const data)
+    -> load_status
+{
+    auto const u16 = [data](size_t const at) { return read_le<uint16_t>(data.subspan(at)); };
+    auto const u32 = [data](size_t const at) { return read_le<uint32_t>(data.subspan(at)); };
+    if (data.size() < bmp_masks_offset + 16) {
+        return _decode_stb(data);
+    }
+
+    // Only the uncompressed 24 and 32 bit formats with byte aligned channels are read here, from
+    // the mapping to the pixels; stb handles the rest
+    auto const offset      = u32(10);
+    auto const header_size = u32(14);
+    auto const raw_width   = static_cast<int32_t>(u32(18));
+    auto const raw_height  = static_cast<int32_t>(u32(22));
+    auto const bpp         = u16(28);
+    auto const compression = u32(30);
+
+    auto masks = std::array<uint32_t, 4>{};  // red, green, blue, alpha
+    if (compression == bmp_rgb and bpp == 24) {
+        masks = {0xff0000u, 0xff00u, 0xffu, 0u};
+    } else if (compression == bmp_rgb and bpp == 32) {
+        masks = {0xff0000u, 0xff00u, 0xffu, 0xff000000u};
+    } else if ((compression == bmp_bitfields or compression == bmp_alpha_bitfields) and bpp == 32) {
+        auto const has_alpha = header_size >= 56 or compression == bmp_alpha_bitfields;
+        masks = {u32(bmp_masks_offset), u32(bmp_masks_offset + 4), u32(bmp_masks_offset + 8), has_alpha ? u32(bmp_masks_offset + 12) : 0u};
+    } else {
+        return _decode_stb(data);
+    }
+    auto shifts = std::array<int, 4>{};
+    for (auto c = 0; c < 4; ++c) {
+        shifts[c] = std::countr_zero(masks[c]);
+        if (masks[c] != 0 and (masks[c] >> shifts[c] != 0xff or shifts[c] % 8 != 0)) {
+            return _decode_stb(data);
+        }
     }
-    char check[3] = "\0\0";
-    in.get(check[0]).get(check[1]).get(check[2]);
-    if (check[0] != 'P' or check[1] != '3' or check[2] != '\n') {
+
+    auto const width  = static_cast<size_t>(raw_width);
+    auto const height = static_cast<size_t>(raw_height < 0 ? -static_cast<int64_t>(raw_height) : raw_height);
+    auto const stride = (bpp * width + 31) / 32 * 4;
+    if (header_size < 40 or raw_width <= 0 or height == 0 or offset > data.size() or stride > (data.size() - offset) / height) {
         return load_status::failure;
     }
-    in.exceptions(std::ios_base::failbit | std::ios_base::badbit);
 
-    auto width  = 0ul;
-    auto height = 0ul;
-    auto max_color = 0;
-    in >> width >> height >> max_color;
-    auto buffer = std::vector<rgba>{};
-    buffer.reserve(width * height);
-    for (size_t i = 0; i < width * height; ++i) {
-        uint16_t r, g, b;
-        in >> r >> g >> b;
-        buffer.emplace_back(r, g, b, 255);
+    _reshape(width, height);
+    auto const bytes_per_pixel = bpp / 8u;
+    auto all_transparent = true;
+    for (size_t y = 0; y < height; ++y) {
+        auto const src_row = raw_height < 0 ? y : height - 1 - y;
+        auto const * in = reinterpret_cast<uint8_t const *>(data.data()) + offset + src_row * stride;
+        auto * out = row_ptr(y);
+        for (size_t x = 0; x < width; ++x, in += bytes_per_pixel) {
+            auto channel = [in, &shifts](int const c) { return in[shifts[c] / 8]; };
+            out[x] = {channel(0), channel(1), channel(2), masks[3] != 0 ? channel(3) : uint8_t{255}};
+            all_transparent = all_transparent and out[x].a == 0;
+        }
+    }
+    // like stb, a 32 bit image without alpha has the unused channel set to zero
+    if (masks[3] != 0 and all_transparent) {
+        std::ranges::for_each(_pixels, [](rgba & c) { c.a = 255; });
+    }
+    if (masks[3] != 0) {
+        _premultiply_loaded();
     }
+    return load_status::success;
+}
 
-    _pixels = std::move(buffer);
-    _width = width;
-    _height = height;
+auto image::_decode_spl(std::span<std::byte const> const data)
+    -> load_status
+{
+    if (data.size() < spl_header_size or not std::ranges::equal(data.first(spl_magic.size()), std::as_bytes(std::span{spl_magic}))) {
+        return load_status::failure;
+    }
+    auto const width  = size_t{read_le<uint32_t>(data.subspan(8))};
+    auto const height = size_t{read_le<uint32_t>(data.subspan(12))};
+    // divided, since the product of two 32 bit sizes can wrap around
+    if (height != 0 and width > (data.size() - spl_header_size) / 4 / height) {
+        return load_status::failure;
+    }
+    _reshape(width, height);
+    for (size_t y = 0; y < height; ++y) {
+        std::memcpy(row_ptr(y), data.data() + spl_header_size + 4 * width * y, 4 * width);
+    }
+    _premultiply_loaded();
     return load_status::success;
 }
 
+void image::_premultiply_loaded() noexcept
+{
+    if (premultiplied()) {
+        std::ranges::transform(_pixels, _pixels.begin(), [](rgba const c) {
+            return stored_color(c, blend_mode::premultiplied);
+        });
+    }
+}
+
 image::operator basic_viewport<false>() & noexcept
 {
     return basic_viewport<false>{*this};
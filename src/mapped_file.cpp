@@ -0,0 +1,102 @@
+/**
+ * @author      : rbrugo, momokrono
+ * @file        : mapped_file
+ * @created     : Saturday Oct 17, 2026 21:40:12 CEST
+ * @license     : MIT
+ */
+
+#include "spl/detail/mapped_file.hpp"
+
+#include <fstream>
+#include <utility>
+
+#if __has_include(<sys/mman.h>) and __has_include(<unistd.h>)
+#define SPL_HAS_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace spl::detail
+{
+
+auto mapped_file::open(std::filesystem::path const & filename, access_pattern const access)
+    -> std::optional<mapped_file>
+{
+    auto result = mapped_file{};
+#ifdef SPL_HAS_MMAP
+    auto const fd = ::open(filename.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return std::nullopt;
+    }
+    struct stat info;
+    if (::fstat(fd, &info) != 0) {
+        ::close(fd);
+        return std::nullopt;
+    }
+    result._size = static_cast<std::size_t>(info.st_size);
+    if (result._size > 0) {
+        auto const ptr = ::mmap(nullptr, result._size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (ptr == MAP_FAILED) {
+            ::close(fd);
+            return std::nullopt;
+        }
+        ::madvise(ptr, result._size, access == access_pattern::sequential ? MADV_SEQUENTIAL : MADV_RANDOM);
+        result._data = static_cast<std::byte *>(ptr);
+    }
+    // the mapping keeps the file alive
+    ::close(fd);
+#else
+    auto in = std::ifstream{filename, std::ios_base::binary | std::ios_base::ate};
+    if (not in) {
+        return std::nullopt;
+    }
+    result._fallback.resize(static_cast<std::size_t>(in.tellg()));
+    in.seekg(0);
+    if (not in.read(reinterpret_cast<char *>(result._fallback.data()), static_cast<std::streamsize>(result._fallback.size()))) {
+        return std::nullopt;
+    }
+    result._data = result._fallback.data();
+    result._size = result._fallback.size();
+#endif
+    return result;
+}
+
+mapped_file::mapped_file(mapped_file && other) noexcept :
+    _data{std::exchange(other._data, nullptr)},
+    _size{std::exchange(other._size, 0)},
+    _fallback{std::move(other._fallback)}
+{}
+
+auto mapped_file::operator=(mapped_file && other) noexcept
+    -> mapped_file &
+{
+    if (this != &other) {
+        close();
+        _data     = std::exchange(other._data, nullptr);
+        _size     = std::exchange(other._size, 0);
+        _fallback = std::move(other._fallback);
+    }
+    return *this;
+}
+
+mapped_file::~mapped_file() noexcept
+{
+    close();
+}
+
+void mapped_file::close() noexcept
+{
+#ifdef SPL_HAS_MMAP
+    if (_data != nullptr) {
+        ::munmap(_data, _size);
+    }
+#else
+    _fallback.clear();
+#endif
+    _data = nullptr;
+    _size = 0;
+}
+
+} // namespace spl::detail
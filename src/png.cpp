@@ -0,0 +1,268 @@
+/**
+ * @author      : rbrugo, momokrono
+ * @file        : png
+ * @created     : Saturday Oct 17, 2026 23:05:41 CEST
+ * @license     : MIT
+ */
+
+#include "spl/detail/png.hpp"
+#include "spl/executor.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <span>
+#include <string_view>
+
+#include <zlib.h>
+
+namespace spl::detail
+{
+
+namespace
+{
+using graphics::png_filter;
+
+constexpr auto signature     = std::array<uint8_t, 8>{137, 80, 78, 71, 13, 10, 26, 10};
+constexpr auto channels      = std::size_t{4};
+constexpr auto strip_bytes   = std::size_t{256 * 1024};     // filtered bytes compressed by a task
+constexpr auto window_bytes  = std::size_t{32 * 1024};      // the deflate window
+
+auto paeth(int const a, int const b, int const c) noexcept
+    -> uint8_t
+{
+    auto const p = a + b - c;
+    auto const pa = std::abs(p - a);
+    auto const pb = std::abs(p - b);
+    auto const pc = std::abs(p - c);
+    if (pa <= pb and pa <= pc) {
+        return static_cast<uint8_t>(a);
+    }
+    return static_cast<uint8_t>(pb <= pc ? b : c);
+}
+
+/// Writes in `out` the `n` bytes of `row` filtered with `filter`, `above` being the previous row
+void apply_filter(png_filter const filter, uint8_t const * row, uint8_t const * above, std::size_t const n, uint8_t * out) noexcept
+{
+    auto const left       = [row](std::size_t i)   { return i >= channels ? row[i - channels] : 0; };
+    auto const above_left = [above](std::size_t i) { return i >= channels ? above[i - channels] : 0; };
+    switch (filter) {
+    case png_filter::none:
+        std::memcpy(out, row, n);
+        break;
+    case png_filter::sub:
+        for (std::size_t i = 0; i < n; ++i) { out[i] = static_cast<uint8_t>(row[i] - left(i)); }
+        break;
+    case png_filter::up:
+        for (std::size_t i = 0; i < n; ++i) { out[i] = static_cast<uint8_t>(row[i] - above[i]); }
+        break;
+    case png_filter::average:
+        for (std::size_t i = 0; i < n; ++i) { out[i] = static_cast<uint8_t>(row[i] - ((left(i) + above[i]) >> 1)); }
+        break;
+    case png_filter::paeth:
+        for (std::size_t i = 0; i < n; ++i) { out[i] = static_cast<uint8_t>(row[i] - paeth(left(i), above[i], above_left(i))); }
+        break;
+    case png_filter::adaptive:
+        break;
+    }
+}
+
+/// Writes the filter type and the filtered row in `out`, which is `n + 1` bytes long
+void filter_row(
+    png_filter const filter, uint8_t const * row, uint8_t const * above, std::size_t const n,
+    uint8_t * out, std::vector<uint8_t> & scratch
+)
+{
+    if (filter != png_filter::adaptive) {
+        out[0] = static_cast<uint8_t>(filter);
+        apply_filter(filter, row, above, n, out + 1);
+        return;
+    }
+    // the smallest sum of the differences as signed bytes, a good estimate of the entropy
+    auto best = std::numeric_limits<std::size_t>::max();
+    for (auto const candidate : {png_filter::none, png_filter::sub, png_filter::up, png_filter::average, png_filter::paeth}) {
+        apply_filter(candidate, row, above, n, scratch.data());
+        auto cost = std::size_t{0};
+        for (std::size_t i = 0; i < n; ++i) {
+            cost += static_cast<std::size_t>(std::abs(static_cast<int8_t>(scratch[i])));
+        }
+        if (cost < best) {
+            best = cost;
+            out[0] = static_cast<uint8_t>(candidate);
+            std::memcpy(out + 1, scratch.data(), n);
+        }
+    }
+}
+
+void put_u32(std::vector<std::byte> & out, uint32_t const value)
+{
+    for (auto shift : {24, 16, 8, 0}) {
+        out.push_back(static_cast<std::byte>(value >> shift));
+    }
+}
+
+/// Appends a chunk whose data is the concatenation of `parts`
+void put_chunk(std::vector<std::byte> & out, std::string_view const tag, std::initializer_list<std::span<uint8_t const>> const parts)
+{
+    auto length = std::size_t{0};
+    for (auto const part : parts) {
+        length += part.size();
+    }
+    put_u32(out, static_cast<uint32_t>(length));
+    auto const start = out.size();
+    out.resize(start + 4 + length);
+    auto * at = reinterpret_cast<uint8_t *>(out.data()) + start;
+    std::memcpy(at, tag.data(), 4);
+    auto * data = at + 4;
+    for (auto const part : parts) {
+        if (not part.empty()) {
+            std::memcpy(data, part.data(), part.size());
+            data += part.size();
+        }
+    }
+    put_u32(out, static_cast<uint32_t>(crc32(0, at, static_cast<uInt>(4 + length))));
+}
+
+/// A strip compressed as raw deflate and the adler32 of its uncompressed bytes
+struct strip
+{
+    std::vector<uint8_t> data;
+    uLong adler = 1;
+    bool ok = false;
+};
+
+/// Compresses `input` using `dictionary`, the end of the previous strip; unless it is the last
+/// strip, the stream is left open and flushed to a byte boundary
+auto compress_strip(std::span<uint8_t const> const dictionary, std::span<uint8_t const> const input, bool const last, int const level)
+    -> strip
+{
+    auto result = strip{};
+    auto stream = z_stream{};
+    if (deflateInit2(&stream, level, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        return result;
+    }
+    if (not dictionary.empty()) {
+        deflateSetDictionary(&stream, dictionary.data(), static_cast<uInt>(dictionary.size()));
+    }
+    // the bound is for a finished stream, the flush adds an empty stored block at most
+    result.data.resize(deflateBound(&stream, input.size()) + 16);
+    stream.next_in   = const_cast<Bytef *>(input.data());
+    stream.avail_in  = static_cast<uInt>(input.size());
+    stream.next_out  = result.data.data();
+    stream.avail_out = static_cast<uInt>(result.data.size());
+    auto const status = deflate(&stream, last ? Z_FINISH : Z_SYNC_FLUSH);
+    result.ok = last ? status == Z_STREAM_END : status == Z_OK and stream.avail_in == 0 and stream.avail_out > 0;
+    result.data.resize(result.data.size() - stream.avail_out);
+    deflateEnd(&stream);
+    result.adler = adler32(1, input.data(), static_cast<uInt>(input.size()));
+    return result;
+}
+} // namespace
+
+bool encode_png(graphics::image_view const v, graphics::save_options const & options, graphics::byte_sink const & write)
+{
+    auto const width  = v.width();
+    auto const height = v.height();
+    if (width == 0 or height == 0 or width > std::numeric_limits<int32_t>::max() / channels
+        or height > std::numeric_limits<int32_t>::max()) {
+        return false;
+    }
+    auto const max_threads = static_cast<std::size_t>(std::max<int16_t>(options.threads, 0));
+    auto const level = std::clamp<int>(options.png_compression, 0, 9);
+
+    // whole rows in each strip; their size does not depend on the threads, nor does the result.
+    // A batch of strips is filtered and compressed in parallel, then written before the next one
+    auto const row_bytes = channels * width;
+    auto const rows_per_strip = std::max<std::size_t>(strip_bytes / (row_bytes + 1), 1);
+    auto const strip_count = (height + rows_per_strip - 1) / rows_per_strip;
+    auto const threads = max_threads == 0 ? spl::default_executor().concurrency() + 1 : max_threads;
+    auto const strips_per_batch = 2 * std::max<std::size_t>(threads, 1);
+
+    auto chunk = std::vector<std::byte>{};
+    auto const emit = [&](std::string_view const tag, std::initializer_list<std::span<uint8_t const>> const parts) {
+        chunk.clear();
+        put_chunk(chunk, tag, parts);
+        write(chunk);
+    };
+
+    auto header = std::array<uint8_t, 13>{};
+    for (auto i = 0; i < 4; ++i) {
+        header[i]     = static_cast<uint8_t>(width >> (24 - 8 * i));
+        header[4 + i] = static_cast<uint8_t>(height >> (24 - 8 * i));
+    }
+    header[8] = 8;      // bits per channel
+    header[9] = 6;      // RGBA
+    write(std::as_bytes(std::span{signature}));
+    emit("IHDR", {header});
+
+    // the zlib header and checksum wrap the strips, one IDAT chunk each
+    auto const flevel = level < 2 ? 0 : level < 6 ? 1 : level == 6 ? 2 : 3;
+    auto const cmf = uint8_t{0x78};     // deflate, 32K window
+    auto const flg = static_cast<uint8_t>(flevel << 6 | (31 - (cmf * 256 + (flevel << 6)) % 31) % 31);
+    auto const zlib_header = std::array<uint8_t, 2>{cmf, flg};
+    auto adler = adler32(0, nullptr, 0);
+
+    // the filtered rows of the batch, after the end of the previous one used as dictionary
+    auto filtered   = std::vector<uint8_t>{};
+    auto dictionary = std::vector<uint8_t>{};
+    auto strips     = std::vector<strip>{};
+    for (auto first = std::size_t{0}; first < strip_count; first += strips_per_batch) {
+        auto const last_strip = std::min(first + strips_per_batch, strip_count);
+        auto const row_from = first * rows_per_strip;
+        auto const row_to   = std::min(last_strip * rows_per_strip, height);
+        filtered.resize((row_to - row_from) * (row_bytes + 1));
+
+        // the filters look at the unfiltered rows only, so the rows are independent
+        spl::parallel_for(row_to - row_from, [&](std::size_t const from, std::size_t const to) {
+            auto const zeros = std::vector<uint8_t>(row_bytes);
+            auto scratch = std::vector<uint8_t>(row_bytes);
+            for (auto i = from; i < to; ++i) {
+                auto const y     = row_from + i;
+                auto const row   = reinterpret_cast<uint8_t const *>(v.row_ptr(static_cast<int_fast32_t>(y)));
+                auto const above = y == 0 ? zeros.data() : reinterpret_cast<uint8_t const *>(v.row_ptr(static_cast<int_fast32_t>(y - 1)));
+                filter_row(options.filter, row, above, row_bytes, filtered.data() + i * (row_bytes + 1), scratch);
+            }
+        }, max_threads);
+
+        strips.assign(last_strip - first, strip{});
+        spl::parallel_for(strips.size(), [&](std::size_t const from, std::size_t const to) {
+            for (auto i = from; i < to; ++i) {
+                auto const begin = i * rows_per_strip * (row_bytes + 1);
+                auto const end   = std::min((i + 1) * rows_per_strip * (row_bytes + 1), filtered.size());
+                auto const input = std::span<uint8_t const>{filtered}.subspan(begin, end - begin);
+                auto const before = i == 0
+                                  ? std::span<uint8_t const>{dictionary}
+                                  : std::span<uint8_t const>{filtered}.subspan(begin - std::min(begin, window_bytes), std::min(begin, window_bytes));
+                strips[i] = compress_strip(before, input, first + i + 1 == strip_count, level);
+            }
+        }, max_threads);
+        if (not std::ranges::all_of(strips, &strip::ok)) {
+            return false;
+        }
+
+        for (auto i = std::size_t{0}; i < strips.size(); ++i) {
+            auto const begin = i * rows_per_strip * (row_bytes + 1);
+            auto const end   = std::min((i + 1) * rows_per_strip * (row_bytes + 1), filtered.size());
+            adler = adler32_combine(adler, strips[i].adler, static_cast<z_off_t>(end - begin));
+            auto const is_first = first + i == 0;
+            auto const is_last  = first + i + 1 == strip_count;
+            auto const zlib_footer = std::array<uint8_t, 4>{
+                static_cast<uint8_t>(adler >> 24), static_cast<uint8_t>(adler >> 16), static_cast<uint8_t>(adler >> 8), static_cast<uint8_t>(adler)
+            };
+            emit("IDAT", {
+                is_first ? std::span<uint8_t const>{zlib_header} : std::span<uint8_t const>{},
+                strips[i].data,
+                is_last ? std::span<uint8_t const>{zlib_footer} : std::span<uint8_t const>{}
+            });
+        }
+        auto const keep = std::min(filtered.size(), window_bytes);
+        dictionary.assign(filtered.end() - static_cast<std::ptrdiff_t>(keep), filtered.end());
+    }
+    emit("IEND", {});
+    return true;
+}
+
+} // namespace spl::detail
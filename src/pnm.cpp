@@ -0,0 +1,315 @@
+/**
+ * @author      : rbrugo, momokrono
+ * @file        : pnm
+ * @created     : Saturday Oct 17, 2026 20:14:36 CEST
+ * @license     : MIT
+ */
+
+#include "spl/pnm.hpp"
+#include "spl/detail/exceptions.hpp"
+
+#include <cctype>
+#include <limits>
+#include <optional>
+#include <sstream>
+#include <string>
+
+#include <fmt/core.h>
+
+namespace spl::graphics
+{
+
+namespace
+{
+/// Skips the whitespaces and the comments, then reads a decimal number; the character after it is
+/// left in the stream
+auto read_number(std::istream & in)
+    -> std::optional<std::size_t>
+{
+    auto c = in.get();
+    while (in) {
+        if (c == '#') {
+            in.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+        } else if (not std::isspace(c)) {
+            break;
+        }
+        c = in.get();
+    }
+    if (not in or not std::isdigit(c)) {
+        return std::nullopt;
+    }
+    auto value = std::size_t{0};
+    while (true) {
+        value = value * 10 + static_cast<std::size_t>(c - '0');
+        if (value > std::numeric_limits<uint32_t>::max()) {
+            return std::nullopt;
+        }
+        if (not std::isdigit(in.peek())) {
+            return value;
+        }
+        c = in.get();
+    }
+}
+
+/// A read-only stream buffer on bytes already in memory, which are read without further copies
+class memory_buffer : public std::streambuf
+{
+public:
+    explicit memory_buffer(std::span<std::byte const> const data)
+    {
+        // the get area is never written through
+        auto const begin = const_cast<char *>(reinterpret_cast<char const *>(data.data()));
+        setg(begin, begin, begin + data.size());
+    }
+
+protected:
+    auto seekoff(off_type const off, std::ios_base::seekdir const dir, std::ios_base::openmode const which)
+        -> pos_type override
+    {
+        auto const base = dir == std::ios_base::beg ? eback() : dir == std::ios_base::cur ? gptr() : egptr();
+        auto const to = base - eback() + off;
+        if (not (which & std::ios_base::in) or to < 0 or to > egptr() - eback()) {
+            return pos_type(off_type(-1));
+        }
+        setg(eback(), eback() + to, egptr());
+        return pos_type(to);
+    }
+
+    auto seekpos(pos_type const pos, std::ios_base::openmode const which)
+        -> pos_type override
+    { return seekoff(off_type(pos), std::ios_base::beg, which); }
+};
+} // namespace
+
+pnm_reader::pnm_reader(std::filesystem::path const & filename)
+{
+    if (not std::filesystem::exists(filename)) {
+        _status = load_status::file_not_found;
+        return;
+    }
+    auto file = std::make_unique<std::filebuf>();
+    if (file->open(filename, std::ios_base::in | std::ios_base::binary)) {
+        _source = std::move(file);
+        _start();
+    }
+}
+
+pnm_reader::pnm_reader(std::span<std::byte const> const data) :
+    _source{std::make_unique<memory_buffer>(data)}
+{
+    _start();
+}
+
+void pnm_reader::_start()
+{
+    _in.rdbuf(_source.get());
+    _status = _read_header();
+    if (_status == load_status::success) {
+        auto const sample_size = _maxval > 255 ? 2u : 1u;
+        // an ASCII sample takes at least a byte: a header promising more rows than the data
+        // holds is rejected before anyone allocates them
+        auto const row_bytes = _width * _depth * (_ascii ? 1u : sample_size);
+        auto const here = _source->pubseekoff(0, std::ios_base::cur, std::ios_base::in);
+        auto const end  = _source->pubseekoff(0, std::ios_base::end, std::ios_base::in);
+        if (here != -1 and end != -1) {
+            _source->pubseekpos(here, std::ios_base::in);
+            if (_height > static_cast<std::size_t>(end - here) / row_bytes) {
+                _status = load_status::failure;
+                return;
+            }
+        }
+        _buffer.resize(_width * _depth * sample_size);
+    }
+}
+
+auto pnm_reader::_read_header()
+    -> load_status
+{
+    char magic[2] = {};
+    if (not _in.read(magic, 2) or magic[0] != 'P') {
+        return load_status::failure;
+    }
+    switch (magic[1]) {
+    case '2': _ascii = true;  _depth = 1; break;
+    case '3': _ascii = true;  _depth = 3; break;
+    case '5': _ascii = false; _depth = 1; break;
+    case '6': _ascii = false; _depth = 3; break;
+    case '7': return _read_pam_header();
+    default: return load_status::failure;
+    }
+
+    auto const width  = read_number(_in);
+    auto const height = read_number(_in);
+    auto const maxval = read_number(_in);
+    // a single whitespace separates the header from the pixels
+    if (not width or not height or not maxval or not std::isspace(_in.get())) {
+        return load_status::failure;
+    }
+    if (*width == 0 or *height == 0 or *maxval == 0 or *maxval > 65535) {
+        return load_status::failure;
+    }
+    _width  = *width;
+    _height = *height;
+    _maxval = static_cast<uint16_t>(*maxval);
+    return load_status::success;
+}
+
+auto pnm_reader::_read_pam_header()
+    -> load_status
+{
+    auto width  = std::size_t{0};
+    auto height = std::size_t{0};
+    auto depth  = std::size_t{0};
+    auto maxval = std::size_t{0};
+    for (auto line = std::string{}; std::getline(_in, line); ) {
+        auto tokens = std::istringstream{line};
+        auto key = std::string{};
+        if (not (tokens >> key) or key.starts_with('#')) {
+            continue;
+        }
+        if (key == "ENDHDR") {
+            if (width == 0 or height == 0 or depth == 0 or depth > 4 or maxval == 0 or maxval > 65535) {
+                return load_status::failure;
+            }
+            _width  = width;
+            _height = height;
+            _depth  = static_cast<uint8_t>(depth);
+            _maxval = static_cast<uint16_t>(maxval);
+            return load_status::success;
+        }
+        // the tuple type is implied by the depth
+        if      (key == "WIDTH")  { tokens >> width;  }
+        else if (key == "HEIGHT") { tokens >> height; }
+        else if (key == "DEPTH")  { tokens >> depth;  }
+        else if (key == "MAXVAL") { tokens >> maxval; }
+        else if (key != "TUPLTYPE") {
+            return load_status::failure;
+        }
+        if (not tokens and not tokens.eof()) {
+            return load_status::failure;
+        }
+    }
+    return load_status::failure;
+}
+
+bool pnm_reader::read_row(std::span<rgba> const row)
+{
+    if (row.size() != _width) {
+        throw spl::invalid_argument{"'pnm_reader::read_row' requires a row as wide as the image"};
+    }
+    if (_status != load_status::success or _row == _height) {
+        return false;
+    }
+
+    auto const samples = _width * _depth;
+    auto const wide = _maxval > 255;
+    if (_ascii) {
+        for (std::size_t i = 0; i < samples; ++i) {
+            auto const value = read_number(_in);
+            if (not value) {
+                _status = load_status::failure;
+                return false;
+            }
+            _buffer[i] = static_cast<uint8_t>((std::min<std::size_t>(*value, _maxval) * 255 + _maxval / 2) / _maxval);
+        }
+    } else if (_depth == 4 and _maxval == 255) {
+        // already in the layout of the pixels
+        auto const bytes = static_cast<std::streamsize>(4 * _width);
+        if (not _in.read(reinterpret_cast<char *>(row.data()), bytes)) {
+            _status = load_status::failure;
+            return false;
+        }
+        ++_row;
+        return true;
+    } else {
+        auto const bytes = static_cast<std::streamsize>(_buffer.size());
+        if (not _in.read(reinterpret_cast<char *>(_buffer.data()), bytes)) {
+            _status = load_status::failure;
+            return false;
+        }
+        if (wide or _maxval != 255) {
+            // scaled in place: the 8 bit samples are never ahead of the ones still to be read
+            for (std::size_t i = 0; i < samples; ++i) {
+                auto const value = wide ? (_buffer[2 * i] << 8 | _buffer[2 * i + 1]) : _buffer[i];
+                _buffer[i] = static_cast<uint8_t>((std::min<unsigned>(value, _maxval) * 255 + _maxval / 2) / _maxval);
+            }
+        }
+    }
+
+    auto const * in = _buffer.data();
+    switch (_depth) {
+    case 1: for (auto & px : row) { px = {in[0], in[0], in[0], 255};   in += 1; } break;
+    case 2: for (auto & px : row) { px = {in[0], in[0], in[0], in[1]}; in += 2; } break;
+    case 3: for (auto & px : row) { px = {in[0], in[1], in[2], 255};   in += 3; } break;
+    case 4: std::ranges::copy_n(in, samples, reinterpret_cast<uint8_t *>(row.data())); break;
+    }
+    ++_row;
+    return true;
+}
+
+pnm_writer::pnm_writer(
+    std::filesystem::path const & filename, std::size_t const width, std::size_t const height, pnm_format const format
+) :
+    _file{std::make_unique<std::filebuf>()},
+    _width{width}, _height{height},
+    _format{format}
+{
+    if (_file->open(filename, std::ios_base::out | std::ios_base::binary)) {
+        _out.rdbuf(_file.get());
+    }
+    _start();
+}
+
+pnm_writer::pnm_writer(std::ostream & out, std::size_t const width, std::size_t const height, pnm_format const format) :
+    _width{width}, _height{height},
+    _format{format}
+{
+    _out.rdbuf(out.rdbuf());
+    _start();
+}
+
+void pnm_writer::_start()
+{
+    auto const header = _format == pnm_format::ppm
+                      ? fmt::format("P6\n{} {}\n255\n", _width, _height)
+                      : fmt::format("P7\nWIDTH {}\nHEIGHT {}\nDEPTH 4\nMAXVAL 255\nTUPLTYPE RGB_ALPHA\nENDHDR\n", _width, _height);
+    _out.write(header.data(), static_cast<std::streamsize>(header.size()));
+    if (_format == pnm_format::ppm) {
+        _buffer.resize(3 * _width);
+    }
+}
+
+bool pnm_writer::write_row(std::span<rgba const> const row)
+{
+    if (row.size() != _width) {
+        throw spl::invalid_argument{"'pnm_writer::write_row' requires a row as wide as the image"};
+    }
+    if (not _out or _row == _height) {
+        return false;
+    }
+
+    if (_format == pnm_format::pam) {
+        _out.write(reinterpret_cast<char const *>(row.data()), static_cast<std::streamsize>(4 * _width));
+    } else {
+        auto out = _buffer.data();
+        for (auto const [r, g, b, a] : row) {
+            *out++ = static_cast<uint8_t>(a * r / 255);
+            *out++ = static_cast<uint8_t>(a * g / 255);
+            *out++ = static_cast<uint8_t>(a * b / 255);
+        }
+        _out.write(reinterpret_cast<char const *>(_buffer.data()), static_cast<std::streamsize>(_buffer.size()));
+    }
+    ++_row;
+    return _out.good();
+}
+
+bool pnm_writer::close()
+{
+    _out.flush();
+    if (_file and not _file->close()) {
+        _out.setstate(std::ios_base::failbit);
+    }
+    return not _out.fail() and _row == _height;
+}
+
+} // namespace spl::graphics
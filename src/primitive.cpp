@@ -6,6 +6,8 @@
  */
 
 #include "spl/primitive.hpp"
+#include <limits>
+#include <numeric>
 #include <numbers>
 
 namespace spl::graphics
@@ -13,63 +15,556 @@ namespace spl::graphics
 
 namespace detail
 {
-    template <typename SegmentList = std::vector<std::pair<vertex, vertex>>>
-    void draw_filled(viewport img, SegmentList && segments_list, spl::graphics::rgba const fill_color) noexcept
+    /// An edge of a polygon, going down from `top` to `bottom` (excluded)
+    ///
+    /// `x` is the crossing with the current scanline in 32.32 fixed point, moved by `step` every
+    /// scanline; both are rounded down, so the error stays below a pixel fraction that no
+    /// crossing can fall in, as long as the edge is shorter than 65536 scanlines
+    struct edge
     {
-        using segment = std::pair<vertex, vertex>;
-        auto segments = std::priority_queue{detail::segment_compare, std::forward<SegmentList>(segments_list)};
+        int_fast32_t top;
+        int_fast32_t bottom;
+        int64_t x;
+        int64_t step;
+        int8_t winding;
+    };
 
-        auto y = detail::top_vertex({segments.top().first, segments.top().second}).y - 1;
+    constexpr auto fixed_one = int64_t{1} << 32;
 
-        auto pop = [&segments]() mutable
-            -> std::optional<segment>
-        {
-            if (segments.empty()) {
-                return std::nullopt;
+    /// The first pixel at the right of the fixed point `x`, or on it
+    constexpr
+    auto ceil_fixed(int64_t const x) noexcept
+        -> int64_t
+    { return (x + fixed_one - 1) >> 32; }
+
+    void fill_polygon(viewport img, std::span<vertex const> const vertices, rgba const color, fill_rule const rule) noexcept
+    {
+        auto const clip = img.clip_box();
+        if (vertices.size() < 3 or clip.empty() or color.a == 0) {
+            return;
+        }
+
+        // the edge table, sorted by the first scanline; horizontal edges cross no scanline
+        auto edges = std::vector<edge>{};
+        edges.reserve(vertices.size());
+        for (auto i = std::size_t{0}; i < vertices.size(); ++i) {
+            auto from = vertices[i];
+            auto to   = vertices[(i + 1) % vertices.size()];
+            if (from.y == to.y) {
+                continue;
+            }
+            auto const winding = static_cast<int8_t>(from.y < to.y ? 1 : -1);
+            if (to.y < from.y) {
+                std::swap(from, to);
+            }
+            auto const dx = int64_t{to.x - from.x} * fixed_one;
+            auto const dy = int64_t{to.y - from.y};
+            auto const step = dx / dy - (dx % dy < 0);
+            edges.push_back({from.y, to.y, int64_t{from.x} * fixed_one, step, winding});
+        }
+        if (edges.empty()) {
+            return;
+        }
+        std::ranges::sort(edges, std::less{}, &edge::top);
+
+        auto const last = std::min(std::ranges::max(edges, std::less{}, &edge::bottom).bottom, clip.y1);
+        auto active = std::vector<edge>{};
+        auto next = edges.begin();
+        auto const value = stored_color(color, img.blending());
+        auto const draw_span = [&](int_fast32_t const y, int64_t const left, int64_t const right) {
+            auto const from = std::max<int64_t>(ceil_fixed(left), clip.x0);
+            auto const to   = std::min<int64_t>(ceil_fixed(right), clip.x1);
+            if (from < to) {
+                auto const row = std::span{img.row_ptr(y) + from, static_cast<std::size_t>(to - from)};
+                if (value.a == 255) {
+                    std::ranges::fill(row, value);
+                } else {
+                    over_span(color, row, img.blending());
+                }
             }
-            auto [p, q] = segments.top();
-            segments.pop();
-            auto [p2, q2] = std::ranges::minmax(p, q, std::less{}, &vertex::y);
-            return segment{q2, p2};
         };
 
-        auto m_and_q = [](segment const s) noexcept {
-            auto const m = (s.first.y - s.second.y) * 1.f / (s.first.x - s.second.x);
-            auto const q = s.first.y - m * s.first.x;
-            return std::pair{m, q};
+        for (auto y = std::max(edges.front().top, clip.y0); y < last; ++y) {
+            std::erase_if(active, [y](edge const & e) { return e.bottom <= y; });
+            for (; next != edges.end() and next->top <= y; ++next) {
+                if (next->bottom <= y) {
+                    continue;
+                }
+                // the edges starting above the clip box are moved to the current scanline
+                active.push_back(*next);
+                active.back().x += next->step * (y - next->top);
+            }
+
+            // the order changes only where the edges cross, an insertion sort is almost linear
+            for (auto i = std::size_t{1}; i < active.size(); ++i) {
+                for (auto j = i; j > 0 and active[j].x < active[j - 1].x; --j) {
+                    std::swap(active[j], active[j - 1]);
+                }
+            }
+
+            if (rule == fill_rule::even_odd) {
+                for (auto i = std::size_t{0}; i + 1 < active.size(); i += 2) {
+                    draw_span(y, active[i].x, active[i + 1].x);
+                }
+            } else {
+                auto winding = 0;
+                auto left = int64_t{0};
+                for (auto const & e : active) {
+                    if (winding == 0) {
+                        left = e.x;
+                    }
+                    winding += e.winding;
+                    if (winding == 0) {
+                        draw_span(y, left, e.x);
+                    }
+                }
+            }
+
+            for (auto & e : active) {
+                e.x += e.step;
+            }
+        }
+    }
+
+    /// A point of the coverage rasterizer, in pixels with 8 fractional bits: the pixel `(x, y)`
+    /// covers `[x, x + 1) ⨉ [y, y + 1)`
+    struct subpixel_point
+    {
+        int64_t x;
+        int64_t y;
+    };
+
+    constexpr auto subpixels = int64_t{256};
+
+    constexpr
+    auto floor_div(int64_t const a, int64_t const b) noexcept
+        -> int64_t
+    { return a / b - (a % b != 0 and (a < 0) != (b < 0)); }
+
+    constexpr
+    auto ceil_div(int64_t const a, int64_t const b) noexcept
+        -> int64_t
+    { return -floor_div(-a, b); }
+
+    /// The accumulation buffer of the coverage rasterizer, a window of `width` pixels and `height`
+    /// rows that can be moved around the image
+    ///
+    /// Every cell holds, in integer subpixels, how far the lines inside the pixel go down (`cover`)
+    /// and how much area they leave at their left (`area`): the coverage of a pixel is the cover
+    /// of the cells up to it, minus its area. The first cell of a row takes the cover of what is
+    /// at the left of the window.
+    ///
+    /// Each line is split at the pixel borders where it crosses them, computed from its ends
+    /// only, so the same line leaves the same cells wherever the window is: tiles and clipped
+    /// renders match the whole image exactly.
+    class coverage_accumulator
+    {
+    public:
+        struct cell
+        {
+            int64_t cover = 0;
+            int64_t area  = 0;
         };
 
-        auto a = pop();
-        auto [a_m, a_q] = m_and_q(*a);
-        auto b = pop();
-        auto [b_m, b_q] = m_and_q(*b);
+    private:
+        std::vector<cell> _cells;
+        int_fast32_t _width;
+        int_fast32_t _height;
+        int_fast32_t _x0 = 0;
+        int_fast32_t _y0 = 0;
+
+    public:
+        coverage_accumulator(int_fast32_t const width, int_fast32_t const height) :
+            _cells(static_cast<std::size_t>((width + 1) * height)), _width{width}, _height{height}
+        {}
+
+        /// Moves the window to start at the pixel `(x0, y0)`
+        void move_to(int_fast32_t const x0, int_fast32_t const y0) noexcept
+        { _x0 = x0; _y0 = y0; }
+
+        auto row(int_fast32_t const y) noexcept
+            -> std::span<cell>
+        { return std::span{_cells}.subspan(static_cast<std::size_t>(y * (_width + 1)), static_cast<std::size_t>(_width + 1)); }
+
+        void add_line(subpixel_point const from, subpixel_point const to) noexcept
+        {
+            if (from.y == to.y) {
+                return;
+            }
+            auto const [top, bottom] = std::minmax(from.y, to.y);
+            auto const first = std::max<int64_t>(floor_div(top, subpixels), _y0);
+            auto const last  = std::min<int64_t>(ceil_div(bottom, subpixels), _y0 + _height);
+            auto const x_at = [&](int64_t const y) {
+                if (y == from.y) { return from.x; }
+                if (y == to.y)   { return to.x; }
+                return from.x + floor_div((y - from.y) * (to.x - from.x), to.y - from.y);
+            };
+            for (auto y = first; y < last; ++y) {
+                auto const row_top = y * subpixels;
+                auto const y_from = std::clamp(from.y, row_top, row_top + subpixels);
+                auto const y_to   = std::clamp(to.y, row_top, row_top + subpixels);
+                _add_row_line(y - _y0, {x_at(y_from), y_from}, {x_at(y_to), y_to});
+            }
+        }
+
+    private:
+        /// Adds the part of a line inside a row; the part at the left of the window adds only its
+        /// cover to the first cell, the part at the right is dropped
+        void _add_row_line(int_fast32_t const y, subpixel_point const from, subpixel_point const to) noexcept
+        {
+            if (from.y == to.y) {
+                return;
+            }
+            auto const cells = row(y);
+            auto const left  = _x0 * subpixels;
+            auto const right = (_x0 + _width) * subpixels;
+            auto const y_at = [&](int64_t const x) {
+                return from.y + floor_div((x - from.x) * (to.y - from.y), to.x - from.x);
+            };
+            auto const add = [&](int64_t const column, subpixel_point const p0, subpixel_point const p1) {
+                if (column < _x0 or column >= _x0 + _width) {
+                    return;
+                }
+                auto & c = cells[static_cast<std::size_t>(column - _x0 + 1)];
+                auto const dy = p1.y - p0.y;
+                c.cover += dy;
+                c.area  += (p0.x + p1.x - 2 * column * subpixels) * dy;
+            };
+
+            auto p0 = from;
+            auto p1 = to;
+            if (std::max(p0.x, p1.x) <= left) {
+                cells[0].cover += p1.y - p0.y;
+                return;
+            }
+            if (std::min(p0.x, p1.x) >= right) {
+                return;
+            }
+            if (std::min(p0.x, p1.x) < left) {
+                auto const side = subpixel_point{left, y_at(left)};
+                cells[0].cover += p0.x < left ? side.y - p0.y : p1.y - side.y;
+                (p0.x < left ? p0 : p1) = side;
+            }
+            if (std::max(p0.x, p1.x) > right) {
+                (p0.x > right ? p0 : p1) = subpixel_point{right, y_at(right)};
+            }
+
+            if (p0.x == p1.x) {
+                add(floor_div(p0.x, subpixels), p0, p1);
+            } else if (p0.x < p1.x) {
+                for (auto column = floor_div(p0.x, subpixels); ; ++column) {
+                    auto const border = (column + 1) * subpixels;
+                    if (p1.x <= border) {
+                        add(column, p0, p1);
+                        break;
+                    }
+                    auto const next = subpixel_point{border, y_at(border)};
+                    add(column, p0, next);
+                    p0 = next;
+                }
+            } else {
+                for (auto column = ceil_div(p0.x, subpixels) - 1; ; --column) {
+                    auto const border = column * subpixels;
+                    if (p1.x >= border) {
+                        add(column, p0, p1);
+                        break;
+                    }
+                    auto const next = subpixel_point{border, y_at(border)};
+                    add(column, p0, next);
+                    p0 = next;
+                }
+            }
+        }
+    };
+
+    void fill_edges(
+        viewport img, std::span<std::pair<point, point> const> const edges, rgba const color,
+        fill_rule const rule, bool const anti_aliasing
+    ) noexcept
+    {
+        constexpr auto band_height = int_fast32_t{32};
 
-        while (true) {
-            if (y < a->second.y) {
-                a = pop();
-                if (not a.has_value()) {
-                    break;
+        if (edges.empty() or color.a == 0) {
+            return;
+        }
+        // the pixel (x, y) covers [x - 0.5, x + 0.5) ⨉ [y - 0.5, y + 0.5) in the coordinates of the points
+        auto const to_subpixel = [](float const v) {
+            // far enough to never be seen, close enough for the products of the crossings to fit in 64 bits
+            constexpr auto limit = double{1 << 22};
+            return static_cast<int64_t>(std::llround(std::clamp(v + 0.5, -limit, limit) * static_cast<double>(subpixels)));
+        };
+        auto lines = std::vector<std::pair<subpixel_point, subpixel_point>>(edges.size());
+        std::ranges::transform(edges, lines.begin(), [&](auto const & e) {
+            return std::pair<subpixel_point, subpixel_point>{
+                {to_subpixel(e.first.x), to_subpixel(e.first.y)},
+                {to_subpixel(e.second.x), to_subpixel(e.second.y)}
+            };
+        });
+        auto x_min = lines.front().first.x;
+        auto x_max = x_min;
+        auto y_min = lines.front().first.y;
+        auto y_max = y_min;
+        for (auto const & [from, to] : lines) {
+            x_min = std::min({x_min, from.x, to.x});
+            x_max = std::max({x_max, from.x, to.x});
+            y_min = std::min({y_min, from.y, to.y});
+            y_max = std::max({y_max, from.y, to.y});
+        }
+        auto const pixel_floor = [](int64_t const v) -> int_fast32_t { return floor_div(v, subpixels); };
+        auto const pixel_ceil  = [](int64_t const v) -> int_fast32_t { return ceil_div(v, subpixels); };
+        auto const area = bounding_box{
+            pixel_floor(x_min), pixel_floor(y_min), pixel_ceil(x_max), pixel_ceil(y_max)
+        }.intersect(img.clip_box());
+        if (area.empty()) {
+            return;
+        }
+
+        // every band visits only the lines crossing it, sorted in buckets
+        auto const bands = static_cast<std::size_t>((area.height() + band_height - 1) / band_height);
+        auto const band_of = [&](int64_t const row) {
+            return static_cast<std::size_t>(std::clamp<int64_t>((row - area.y0) / band_height, 0, static_cast<int64_t>(bands) - 1));
+        };
+        auto const rows_of = [](std::pair<subpixel_point, subpixel_point> const & l) {
+            auto const [top, bottom] = std::minmax(l.first.y, l.second.y);
+            return std::pair{floor_div(top, subpixels), ceil_div(bottom, subpixels)};
+        };
+        auto const visible = [&](std::pair<subpixel_point, subpixel_point> const & l) {
+            auto const [first, last] = rows_of(l);
+            return l.first.y != l.second.y and last > area.y0 and first < area.y1;
+        };
+        auto starts = std::vector<std::size_t>(bands + 1);
+        for (auto const & l : lines) {
+            if (visible(l)) {
+                auto const [first, last] = rows_of(l);
+                for (auto band = band_of(first); band <= band_of(last - 1); ++band) {
+                    ++starts[band + 1];
                 }
-                std::tie(a_m, a_q) = m_and_q(*a);
             }
-            if (y < b->second.y) {
-                b = pop();
-                if (not b.has_value()) {
-                    break;
+        }
+        std::partial_sum(starts.begin(), starts.end(), starts.begin());
+        auto buckets = std::vector<uint32_t>(starts.back());
+        auto next = starts;
+        for (auto i = std::size_t{0}; i < lines.size(); ++i) {
+            if (visible(lines[i])) {
+                auto const [first, last] = rows_of(lines[i]);
+                for (auto band = band_of(first); band <= band_of(last - 1); ++band) {
+                    buckets[next[band]++] = static_cast<uint32_t>(i);
                 }
-                std::tie(b_m, b_q) = m_and_q(*b);
             }
+        }
+
+        auto const width = area.width();
+        auto cells = coverage_accumulator{width, std::min(band_height, area.height())};
+        auto coverage = std::vector<uint8_t>(static_cast<std::size_t>(width));
+        auto const to_coverage = [rule, anti_aliasing](int64_t const sum) {
+            // a pixel fully covered once sums to 2 * subpixels²
+            auto c = static_cast<float>(std::abs(sum)) / static_cast<float>(2 * subpixels * subpixels);
+            if (rule == fill_rule::even_odd) {
+                c = std::fmod(c, 2.f);
+                c = c > 1.f ? 2.f - c : c;
+            }
+            if (not anti_aliasing) {
+                return static_cast<uint8_t>(c >= 0.5f ? 255 : 0);
+            }
+            return static_cast<uint8_t>(std::min(c, 1.f) * 255.f + 0.5f);
+        };
 
-            // trovare le x corrispondente alla y corrente
-            auto x_1 = std::isinf(a_m)
-                     ? a->first.x
-                     : static_cast<int_fast32_t>(std::round((y - a_q) * 1.f / a_m));
-            auto x_2 = std::isinf(b_m)
-                     ? b->first.x
-                     : static_cast<int_fast32_t>(std::round((y - b_q) * 1.f / b_m));
+        for (auto band = std::size_t{0}; band < bands; ++band) {
+            auto const top  = area.y0 + static_cast<int_fast32_t>(band) * band_height;
+            auto const rows = std::min(band_height, area.y1 - top);
+            cells.move_to(area.x0, top);
+            for (auto i = starts[band]; i < starts[band + 1]; ++i) {
+                auto const & [from, to] = lines[buckets[i]];
+                cells.add_line(from, to);
+            }
 
-            img.draw(line{{x_1, y}, {x_2, y}, fill_color, false});
-            --y;
+            for (auto y = int_fast32_t{0}; y < rows; ++y) {
+                auto const row = cells.row(y);
+                auto cover = std::exchange(row[0], {}).cover;
+                for (auto x = int_fast32_t{0}; x < width; ++x) {
+                    auto const c = std::exchange(row[static_cast<std::size_t>(x) + 1], {});
+                    cover += c.cover;
+                    coverage[static_cast<std::size_t>(x)] = to_coverage(cover * 2 * subpixels - c.area);
+                }
+                // blending with no coverage still rounds a translucent pixel, so only the covered
+                // runs are composed: the pixels outside the shape stay untouched whatever the clip
+                auto * const pixels = img.row_ptr(top + y) + area.x0;
+                auto const covered = [](uint8_t const c) { return c != 0; };
+                for (auto from = std::ranges::find_if(coverage, covered); from != coverage.end(); ) {
+                    auto const to = std::find(from, coverage.end(), uint8_t{0});
+                    over_span(
+                        color, std::span<uint8_t const>{from, to},
+                        std::span{pixels + (from - coverage.begin()), static_cast<std::size_t>(to - from)}, img.blending()
+                    );
+                    from = std::find_if(to, coverage.end(), covered);
+                }
+            }
+        }
+    }
+
+    void fill_polygon_antialiased(viewport img, std::span<point const> const vertices, rgba const color, fill_rule const rule) noexcept
+    {
+        if (vertices.size() < 3) {
+            return;
+        }
+        auto edges = std::vector<std::pair<point, point>>(vertices.size());
+        for (auto i = std::size_t{0}; i < vertices.size(); ++i) {
+            edges[i] = {vertices[i], vertices[(i + 1) % vertices.size()]};
+        }
+        fill_edges(img, edges, color, rule, true);
+    }
+
+    /// Fills the polygon with the filler matching the anti-aliasing of the primitive
+    void fill_vertices(viewport img, std::span<vertex const> const vertices, rgba const color, fill_rule const rule, bool const anti_aliasing) noexcept
+    {
+        if (not anti_aliasing) {
+            fill_polygon(img, vertices, color, rule);
+            return;
+        }
+        auto points = std::vector<point>(vertices.size());
+        std::ranges::transform(vertices, points.begin(), [](vertex const v) {
+            return point{static_cast<float>(v.x), static_cast<float>(v.y)};
+        });
+        fill_polygon_antialiased(img, points, color, rule);
+    }
+
+    /// The interval of `t` where `from + t * k` lies in `[lo, hi]`; empty if `first > second`
+    constexpr
+    auto parameter_range(double const from, double const k, double const lo, double const hi) noexcept
+        -> std::pair<double, double>
+    {
+        constexpr auto inf = std::numeric_limits<double>::infinity();
+        if (k == 0) {
+            return lo <= from and from <= hi ? std::pair{-inf, inf} : std::pair{inf, -inf};
+        }
+        auto const t1 = (lo - from) / k;
+        auto const t2 = (hi - from) / k;
+        return {std::min(t1, t2), std::max(t1, t2)};
+    }
+
+    /// The steps along the major axis of the line from `from` to `to` that can be inside `clip`
+    /// enlarged by `margin`, as a closed interval; empty if the line misses it (Liang–Barsky)
+    auto clip_steps(vertex const from, vertex const to, bounding_box const clip, int_fast32_t const margin) noexcept
+        -> std::optional<std::pair<int_fast32_t, int_fast32_t>>
+    {
+        if (clip.empty()) {
+            return std::nullopt;
+        }
+        auto const dx = to.x - from.x;
+        auto const dy = to.y - from.y;
+        if (clip.contains(from.x, from.y) and clip.contains(to.x, to.y)) {
+            return std::pair{int_fast32_t{0}, std::max(std::abs(dx), std::abs(dy))};
+        }
+        // half a pixel more for the rounding on the minor axis
+        auto const [tx0, tx1] = parameter_range(from.x, dx, clip.x0 - margin - 0.5, clip.x1 - 1 + margin + 0.5);
+        auto const [ty0, ty1] = parameter_range(from.y, dy, clip.y0 - margin - 0.5, clip.y1 - 1 + margin + 0.5);
+        auto const t0 = std::max({tx0, ty0, 0.});
+        auto const t1 = std::min({tx1, ty1, 1.});
+        if (t0 > t1) {
+            return std::nullopt;
+        }
+        auto const steps = std::max(std::abs(dx), std::abs(dy));
+        return std::pair{
+            std::max(static_cast<int_fast32_t>(std::floor(t0 * steps)) - 1, int_fast32_t{0}),
+            std::min(static_cast<int_fast32_t>(std::ceil(t1 * steps)) + 1, steps)
+        };
+    }
+
+    /// Calls `plot(x, y)` on the pixels of the line inside `clip`, with integer Bresenham along
+    /// the major axis; the first pixel is skipped if `skip_first`
+    ///
+    /// The state of the first step in the clip box is computed exactly, so a clipped line has the
+    /// same pixels of the whole one
+    template <typename Plot>
+    void walk_bresenham(vertex const start, vertex const end, bounding_box const clip, bool const skip_first, Plot && plot) noexcept
+    {
+        auto const steep = std::abs(end.y - start.y) > std::abs(end.x - start.x);
+        auto const [u1, v1] = steep ? std::pair{start.y, start.x} : std::pair{start.x, start.y};
+        auto const [u2, v2] = steep ? std::pair{end.y, end.x}     : std::pair{end.x, end.y};
+        auto const du = std::abs(u2 - u1);
+        auto const dv = std::abs(v2 - v1);
+        auto const su = u2 >= u1 ? 1 : -1;
+        auto const sv = v2 >= v1 ? 1 : -1;
+
+        auto const steps = clip_steps(start, end, clip, 0);
+        if (not steps) {
+            return;
+        }
+        if (du == 0) {
+            if (not skip_first) {
+                plot(start.x, start.y);
+            }
+            return;
+        }
+
+        // the pixel of the step `i` is `v1 + sv * round(i * dv / du)`, rounding the halves up:
+        // the error is the numerator of the remainder, over `2 * du`
+        auto const first = std::max(steps->first, int_fast32_t{skip_first});
+        auto const last  = steps->second;
+        auto const numerator = 2 * int64_t{first} * dv + du;
+        auto u = u1 + su * first;
+        int_fast32_t v = v1 + sv * (numerator / (2 * int64_t{du}));
+        auto error = numerator % (2 * int64_t{du});
+        for (auto i = first; i <= last; ++i, u += su) {
+            auto const [x, y] = steep ? std::pair{v, u} : std::pair{u, v};
+            if (clip.contains(x, y)) {
+                plot(x, y);
+            }
+            error += 2 * dv;
+            if (error >= 2 * du) {
+                error -= 2 * du;
+                v += sv;
+            }
+        }
+    }
+
+    /// Calls `plot(x, y, coverage)` on the pixels of the anti-aliased line inside `clip`, with
+    /// Xiaolin Wu; the first step is skipped if `skip_first`
+    ///
+    /// Every step along the major axis splits the color between the two pixels around the line,
+    /// the position on the minor axis being in 16.16 fixed point
+    template <typename Plot>
+    void walk_wu(vertex const start, vertex const end, bounding_box const clip, bool const skip_first, Plot && plot) noexcept
+    {
+        auto const steep = std::abs(end.y - start.y) > std::abs(end.x - start.x);
+        auto const [u1, v1] = steep ? std::pair{start.y, start.x} : std::pair{start.x, start.y};
+        auto const [u2, v2] = steep ? std::pair{end.y, end.x}     : std::pair{end.x, end.y};
+        auto const du = std::abs(u2 - u1);
+        auto const su = u2 >= u1 ? 1 : -1;
+
+        auto const steps = clip_steps(start, end, clip, 1);
+        if (not steps or du == 0) {
+            return;
+        }
+        auto const put = [&](int_fast32_t const u, int_fast32_t const v, uint8_t const coverage) {
+            auto const [x, y] = steep ? std::pair{v, u} : std::pair{u, v};
+            if (coverage != 0 and clip.contains(x, y)) {
+                plot(x, y, coverage);
+            }
+        };
+
+        // the position of the step `i` is `v1 + floor(i * dv / du)`, the remainder kept apart so
+        // that it does not depend on the first step drawn
+        auto const floor_div = [](int64_t const n, int64_t const d) { return n / d - (n % d < 0); };
+        auto const first = std::max(steps->first, int_fast32_t{skip_first});
+        auto const last  = steps->second;
+        auto const dv = int64_t{v2 - v1} * 65536;
+        auto const step = floor_div(dv, du);
+        auto const step_remainder = dv - step * du;
+        auto position  = int64_t{v1} * 65536 + floor_div(first * dv, du);
+        auto remainder = first * dv - floor_div(first * dv, du) * du;
+        auto u = u1 + su * first;
+        for (auto i = first; i <= last; ++i, u += su) {
+            auto const v = static_cast<int_fast32_t>(position >> 16);
+            auto const fraction = static_cast<uint8_t>((position >> 8) & 0xff);
+            put(u, v, static_cast<uint8_t>(255 - fraction));
+            put(u, v + 1, fraction);
+            position  += step;
+            remainder += step_remainder;
+            if (remainder >= du) {
+                remainder -= du;
+                ++position;
+            }
         }
     }
 } // namespace detail
@@ -86,38 +581,37 @@ void line::render_on(viewport img) const noexcept
     auto [x1, y1] = start;
     auto [x2, y2] = end;
 
-    auto const width  = img.swidth();
-    auto const height = img.sheight();
+    auto const clip = img.clip_box();
 
     if (x1 == x2) {
-        if (x1 < 0 or x1 >= width) {
+        if (x1 < clip.x0 or x1 >= clip.x1) {
             return;
         }
         auto [from, to] = std::minmax({y1, y2});
-        from = std::max(from, 0l);
-        to   = std::min(to, height - 1);
+        if (from > clip.y1 - 1 or to < clip.y0) {
+            return;
+        }
+        from = std::max(from, clip.y0);
+        to   = std::min(to, clip.y1 - 1);
 
-        for (; from <= to; ++from) {
-            auto & pixel = img.pixel(x1, from);
-            pixel = over(color, pixel);
+        auto const stride = static_cast<std::ptrdiff_t>(img.stride());
+        for (auto pixel = img.row_ptr(from) + x1; from <= to; ++from, pixel += stride) {
+            *pixel = over(color, *pixel, img.blending());
         }
     } else if (y1 == y2) {
-        if (y1 < 0 or y1 >= height) {
+        if (y1 < clip.y0 or y1 >= clip.y1) {
             return;
         }
         auto [from, to] = std::minmax({x1, x2});
-        if (from > width - 1 or to < 0) {
+        if (from > clip.x1 - 1 or to < clip.x0) {
             return;
         }
-        from = std::max(from, 0l);
-        to   = std::min(to, width - 1);
+        from = std::max(from, clip.x0);
+        to   = std::min(to, clip.x1 - 1);
 
-        for (; from <= to; ++from) {
-            auto & pixel = img.pixel(from, y1);
-            pixel = over(color, pixel);
-        }
+        over_span(color, std::span{img.row_ptr(y1) + from, static_cast<size_t>(to - from + 1)}, img.blending());
     } else if (anti_aliasing) {
-        draw_antialiased_parametric(img);
+        draw_antialiased(img);
     }
     else {
         draw_aliased(img);
@@ -131,6 +625,7 @@ void line::draw_antialiased_parametric(viewport img) const noexcept
 
     auto const width  = img.swidth();
     auto const height = img.sheight();
+    auto const clip   = img.clip_box();
 
     if (x2 < x1) {
         std::swap(x2, x1);
@@ -143,17 +638,39 @@ void line::draw_antialiased_parametric(viewport img) const noexcept
     auto const kx = dx * 1.f / distance;
     auto const ky = dy * 1.f / distance * ((y2 > y1) * 2 - 1);
 
-    int_fast32_t t = 0;
-    for (; t < distance; ++t) {
+    auto const in_bounds = [=](int_fast32_t const t) {
         auto const x = x1 + t * kx;
         auto const y = y1 + t * ky;
+        return (std::floor(x) >= 0 and std::floor(y) >= 0) and (std::ceil(x) < width and std::ceil(y) < height);
+    };
+    // The values of `t` for which the line can be in a box, as `[from, to)`; the box is enlarged by
+    // a pixel, so that the rounding errors of the float coordinates cannot exclude any point
+    auto const range_in = [=](double const left, double const top, double const right, double const bottom) {
+        auto const [tx0, tx1] = detail::parameter_range(x1, kx, left - 1, right + 1);
+        auto const [ty0, ty1] = detail::parameter_range(y1, ky, top - 1, bottom + 1);
+        auto const from = std::max(tx0, ty0);
+        auto const to   = std::min(tx1, ty1);
+        auto const to_t = [distance](double const t) {
+            return static_cast<int_fast32_t>(std::clamp<double>(t, 0, distance));
+        };
+        return from > to ? std::pair{distance, distance} : std::pair{to_t(std::floor(from)), to_t(std::ceil(to) + 1)};
+    };
 
-        if ((std::floor(x) >= 0 and std::floor(y) >= 0) and (std::ceil(x) < width and std::ceil(y) < height)) {
-            break;
+    // The points in the viewport are contiguous: the line is drawn from the first one, until it
+    // leaves the viewport. Only the ones near the clip box are visited.
+    auto const [clip_from, clip_to] = range_in(clip.x0 - 1, clip.y0 - 1, clip.x1, clip.y1);
+    auto t = range_in(0, 0, width - 1, height - 1).first;
+    while (t < distance and not in_bounds(t)) {
+        ++t;
+    }
+    if (t < clip_from) {
+        t = clip_from;
+        if (not in_bounds(std::min(t, distance - 1))) {
+            return;
         }
     }
 
-    for (; t < distance; ++t) {
+    for (; t < clip_to; ++t) {
         auto const x = x1 + t * kx;
         auto const y = y1 + t * ky;
 
@@ -166,13 +683,20 @@ void line::draw_antialiased_parametric(viewport img) const noexcept
                 if (rounded_x < 0 or rounded_y < 0) {
                     return;
                 }
+                if (not clip.contains(rounded_x, rounded_y)) {
+                    continue;
+                }
                 auto const x_blend = 1.f - std::abs(x - rounded_x);
 
-                auto & pixel = img.pixel(rounded_x, rounded_y);
-                pixel = over(color.blend(y_blend * x_blend), pixel);
+                auto & pixel = img.pixel_unchecked(rounded_x, rounded_y);
+                pixel = over(color.blend(y_blend * x_blend), pixel, img.blending());
             }
         }
     }
+    if (t < distance) {
+        // the rest of the line is outside of the clip box
+        return;
+    }
     // one last time for the final pixel
     {
         auto const x = x1 + t * kx;
@@ -181,100 +705,33 @@ void line::draw_antialiased_parametric(viewport img) const noexcept
         auto const floorx = std::floor(x);
         auto const floory = std::floor(y);
 
-        if (not (x >= width or y >= height or floorx < 0 or floory < 0)) {
+        if (not (x >= width or y >= height or floorx < 0 or floory < 0) and clip.contains(floorx, floory)) {
             auto const y_blend = 1.f - std::abs(y - floory);
             auto const x_blend = 1.f - std::abs(x - floorx);
 
-            auto & pixel = img.pixel(floorx, floory);
-            pixel = over(color.blend(y_blend * x_blend), pixel);
+            auto & pixel = img.pixel_unchecked(floorx, floory);
+            pixel = over(color.blend(y_blend * x_blend), pixel, img.blending());
         }
     }
 }
 
 void line::draw_aliased(viewport img) const noexcept
 {
-    auto [x1, y1] = start;
-    auto [x2, y2] = end;
-
-    auto const width  = img.swidth();
-    auto const height = img.sheight();
-
-    if (std::abs(x2 - x1) >= std::abs(y2 - y1)) {
-        auto const m = (y2 - y1) * 1.f / (x2 - x1);
-        auto const q = y2 - m * x2;
-
-        auto [from, to] = std::minmax({x1, x2});
-        from = std::clamp(from, 0l, width - 1);
-        to   = std::clamp(to,   0l, width - 1);
-        while (from < 0) { ++from; }
-        for (; from <= to; ++from) {
-            auto const y = m * from + q;
-            if (y >= 0 and y < height) {
-                img.pixel(from, std::lround(y)) = color;
-            }
-        }
-    } else {
-        auto const m_rev = (x2 - x1) * 1.f / (y2 - y1);
-        auto const q = y2 - x2 / m_rev;
-
-        auto [from, to] = std::minmax({y1, y2});
-        from = std::clamp(from, 0l, height - 1);
-        to   = std::clamp(to,   0l, height - 1);
-        while (from < 0) { ++from; }
-        for (; from <= to; ++from) {
-            // y = mx + q
-            // x = (y - q)/m
-            auto const x = (from - q) * m_rev;
-            if (x >= 0 and x < width) {
-                img.pixel(std::lround(x), from) = color;
-            }
-        }
-    }
+    auto const value = stored_color(color, img.blending());
+    detail::walk_bresenham(start, end, img.clip_box(), false, [&](int_fast32_t const x, int_fast32_t const y) {
+        img.pixel_unchecked(x, y) = value;
+    });
 }
 
 void line::draw_antialiased(viewport img) const noexcept
 {
-    auto [x1, y1] = start;
-    auto [x2, y2] = end;
-
-    if (std::abs(x2 - x1) >= std::abs(y2 - y1)) {
-        auto const m = (y2 - y1) * 1.f / (x2 - x1);
-        auto const q = y2 - m * x2;
-
-        auto [from, to] = std::minmax({x1, x2});
-        while (from < 0) { ++from; }
-        for (; from <= to; ++from) {
-            auto const y = m * from + q;
-            if (auto const fy = std::floor(y); fy >= 0.f and fy < img.height()) {
-                auto & pixel = img.pixel(from, static_cast<int_fast32_t>(fy));
-                pixel = over(color.blend(1. - std::abs(y - fy)), pixel);
-            }
-            if (auto const cy = std::ceil(y); cy >= 0.f and cy < img.height()) {
-                auto & pixel = img.pixel(from, static_cast<int_fast32_t>(cy));
-                pixel = over(color.blend(1. - std::abs(y - cy)), pixel);;
-            }
-        }
-    } else {
-        auto const m_rev = (x2 - x1) * 1.f / (y2 - y1);
-        auto const q = y2 - x2 / m_rev;
-
-        auto [from, to] = std::minmax({y1, y2});
-        while (from < 0) { ++from; }
-        for (; from <= to; ++from) {
-            auto const x = (from - q) * m_rev;
-            if (auto const fx = std::floor(x); fx >= 0 and fx < img.width()) {
-                auto & pixel = img.pixel(static_cast<int_fast32_t>(fx), from);
-                pixel = over(color.blend(1. - std::abs(x - fx)), pixel);
-            }
-            if (auto const cx = std::ceil(x); cx >= 0 and cx < img.width()) {
-                auto & pixel = img.pixel(static_cast<int_fast32_t>(cx), from);
-                pixel = over(color.blend(1. - std::abs(x - cx)), pixel);
-            }
-        }
-    }
+    auto const mode = img.blending();
+    detail::walk_wu(start, end, img.clip_box(), false, [&](int_fast32_t const x, int_fast32_t const y, uint8_t const coverage) {
+        auto & pixel = img.pixel_unchecked(x, y);
+        pixel = over(color.blend(coverage), pixel, mode);
+    });
 }
 
-
 void line::_draw_thick(viewport img) const noexcept
 {
     // assumes thicknes > 1
@@ -296,97 +753,42 @@ void line::_draw_thick(viewport img) const noexcept
         return;
     }
 
+    // a capsule around the segment, whose round caps are approximated by a chord every few
+    // pixels, filled with the coverage rasterizer
     auto const radius = thickness / 2.f;
-    auto const width = img.swidth();
-    auto const height = img.sheight();
-
-    auto [pt_from, pt_to] = std::ranges::minmax({start, end}, std::ranges::less{}, &spl::graphics::vertex::x);
-    auto [from, from_y] = pt_from;
-    auto [to, to_y] = pt_to;
-
-    auto const m = (to_y - from_y) * 1. / (to - from);
-    auto const q = to_y - m * to;
-
-    auto const dy = m >= 0 ? 1 : -1;
-    auto const x_off = radius;
-    auto const y_off = radius * dy;
-
-    auto const min_x = std::max<float>(0, from - x_off);
-    auto const max_x = std::min<float>(to + x_off, width - 1);
-
-    auto const distance = [
-        =,
-        q1 = m != 0 ? from_y + from / m : from,
-        q2 = m != 0 ? to_y   + to   / m : to,
-        inv_den = 1 / std::hypot(1, m)
-    ](auto const x, auto const y) {
-        // Check if (x,y) in the plane delimited by the lines passing for from and to, and orthogonal
-        //  to the segment from-to
-        auto const q3 = m != 0 ? y      + x    / m : x;
-
-        // If the point is not in the plane, calculate the distance relative to the nearest point
-        if (q3 < std::min(q1, q2)) {
-            auto varx = q1 <= q2 ? from : to;
-            auto vary = q1 <= q2 ? from_y : to_y;
-            return std::hypot<float>(x - varx, y - vary);
+    auto const dx = static_cast<float>(end.x - start.x);
+    auto const dy = static_cast<float>(end.y - start.y);
+    auto const length = std::hypot(dx, dy);
+    auto const ux = length > 0 ? dx / length : 1.f;
+    auto const uy = length > 0 ? dy / length : 0.f;
+    auto const steps = std::clamp(static_cast<int>(std::ceil(radius * 1.5f)), 2, 64);
+
+    auto outline = std::vector<detail::point>{};
+    outline.reserve(2 * static_cast<std::size_t>(steps) + 2);
+    // half a turn around `center`, from the side given by the normal `(nx, ny)`
+    auto const cap = [&](vertex const center, float const nx, float const ny) {
+        for (auto i = 0; i <= steps; ++i) {
+            auto const angle = std::numbers::pi_v<float> * static_cast<float>(i) / static_cast<float>(steps);
+            auto const c = std::cos(angle);
+            auto const s = std::sin(angle);
+            outline.push_back({
+                static_cast<float>(center.x) + radius * (nx * c + ny * s),
+                static_cast<float>(center.y) + radius * (ny * c - nx * s)
+            });
         }
-
-        if (q3 > std::max(q1, q2)) {
-            auto varx = (q1 >= q2) ? from : to;
-            auto vary = (q1 >= q2) ? from_y : to_y;
-            return std::hypot<float>(x - varx, y - vary);
-        }
-
-        // If it is in the plane, calculate the line-point distance
-        return std::abs(y - m * x - q) * inv_den;
-    };
-
-    // Weight normalized on the distance
-    auto const weight = [&distance, norm = 1.f / radius](auto const x, auto const y) {
-        return 1 - distance(x, y) * norm;
     };
+    cap(end, -uy, ux);
+    cap(start, uy, -ux);
 
-    auto y = std::clamp<float>(
-        m * (from - radius * std::numbers::sqrt2 / 2) + q - y_off,
-        0,
-        width - 1
-    );
-
-    for (; std::abs(m * to + y_off - y) > 0.01 and 0 <= y and y < height; y += dy) {
-        for (int_fast32_t const effective_y : {std::floor(y), std::ceil(y)}) {
-            if (effective_y < 0 or effective_y >= height) {
-                continue;
-            }
-            auto x = min_x;
-            for (auto d = distance(x, effective_y); d > radius and x <= max_x; ) {
-                ++x;
-                d = distance(x, effective_y);
-            }
-            if (x > max_x) {
-                continue;
-            }
-
-            for (; distance(x, effective_y) <= radius and x < max_x; ++x) {
-                for (int_fast32_t const effective_x : {std::floor(x), std::ceil(x)}) {
-                    if (effective_x >= width) {
-                        break;
-                    }
-                    auto const w = weight(effective_x, effective_y);
-                    if (w > 0) {
-                        auto & pixel = img.pixel(effective_x, effective_y);
-                        pixel = over(color.blend(w), pixel);
-                    }
-
-                }
-            }
-        }
-    }
+    detail::fill_polygon_antialiased(img, outline, color, fill_rule::non_zero);
 }
 
 #ifdef PRIMITIVES_BEZIER_HPP
 template <typename Alloc>
 void detail::_bezier_render_aliased(viewport img, std::span<vertex> const v, spl::graphics::rgba const color)
 {
+    auto const clip  = img.clip_box();
+    auto const value = stored_color(color, img.blending());
     switch (std::ssize(v)) {
     case 2: {
         // linear
@@ -425,7 +827,9 @@ void detail::_bezier_render_aliased(viewport img, std::span<vertex> const v, spl
             auto const x = (1 - t) * (1 - t) * x0 + 2 * (1 - t) * t * x1 + t * t * x2;
             auto const y = (1 - t) * (1 - t) * y0 + 2 * (1 - t) * t * y1 + t * t * y2;
 
-            img.pixel(x, std::lround(y)) = color;
+            if (clip.contains(x, std::lround(y))) {
+                img.pixel_unchecked(x, std::lround(y)) = value;
+            }
         }
 
         // B(t) = (1-t)²P0 + 2t(1-t)P1 + t²P2
@@ -455,7 +859,9 @@ void detail::_bezier_render_aliased(viewport img, std::span<vertex> const v, spl
                          + 3 * u * t * t * y2
                          +     t * t * t * y3;
 
-            img.pixel(x, std::lround(y)) = color;
+            if (clip.contains(x, std::lround(y))) {
+                img.pixel_unchecked(x, std::lround(y)) = value;
+            }
         }
 
         // B(t) = (1-t)³P0 + 3t(1-t)²P1 + 3t²(1 - t)P2 + t³P3
@@ -492,7 +898,8 @@ void detail::_bezier_render_aliased(viewport img, std::span<vertex> const v, spl
 }
 #endif // PRIMITIVES_BEZIER_HPP
 
-void rectangle::render_on(viewport img) const noexcept
+auto rectangle::_corners() const noexcept
+    -> std::array<vertex, 4>
 {
     auto const sin = std::sin(_rotation);
     auto const cos = std::cos(_rotation);
@@ -513,12 +920,27 @@ void rectangle::render_on(viewport img) const noexcept
     auto const x4 = static_cast<int_fast32_t>(- std::round(h * sin) + x1);
     auto const y4 = static_cast<int_fast32_t>(std::round(h * cos) + y1);
 
+    return {vertex{x1, y1}, vertex{x2, y2}, vertex{x3, y3}, vertex{x4, y4}};
+}
+
+auto rectangle::bounding_box() const noexcept
+    -> graphics::bounding_box
+{
+    auto const [a, b, c, d] = _corners();
+    return graphics::bounding_box::around({a, b, c, d}, 1);
+}
+
+void rectangle::render_on(viewport img) const noexcept
+{
+    auto const [p1, p2, p3, p4] = _corners();
+    auto const [x1, y1] = p1;
+    auto const [x2, y2] = p2;
+    auto const [x3, y3] = p3;
+    auto const [x4, y4] = p4;
+
     if (_fill_color.a != 0) {
-        detail::draw_filled(img, {
-            {{x1, y1}, {x2, y2}},
-            {{x2, y2}, {x3, y3}},
-            {{x3, y3}, {x4, y4}},
-            {{x1, y1}, {x4, y4}}}, _fill_color);
+        auto const corners = std::array{p1, p2, p3, p4};
+        detail::fill_vertices(img, corners, _fill_color, fill_rule::non_zero, _anti_aliasing);
     }
 
 
@@ -528,6 +950,20 @@ void rectangle::render_on(viewport img) const noexcept
     img.draw(line{{x4, y4}, {x1, y1}, _border_color, _anti_aliasing});
 }
 
+auto regular_polygon::bounding_box() const noexcept
+    -> graphics::bounding_box
+{
+    if (_sides == 0 or _radius <= 0) {
+        return {};
+    }
+    // the vertices lie on a circle of radius `len / (2 sin(theta / 2))` passing through the
+    // center (see `_draw_filled`), so none of them is farther than its diameter
+    auto const theta = 2 * std::numbers::pi / _sides;
+    auto const len   = _radius * std::sqrt(2 - std::cos(theta));
+    auto const reach = len / std::sin(theta / 2);
+    return graphics::bounding_box::around({_center}, static_cast<int_fast32_t>(std::ceil(reach)) + 2);
+}
+
 void regular_polygon::_draw_unfilled(viewport img) const noexcept
 {
     auto const [x_c, y_c] = _center;
@@ -561,26 +997,362 @@ void regular_polygon::_draw_filled(viewport img) const noexcept
     auto       x_p   = x_c - len * std::sin(theta_0);
     auto       y_p   = y_c - len * std::cos(theta_0);
 
-    auto segments = std::vector<std::pair<vertex, vertex>>{};
-    segments.reserve(_sides);
+    auto vertices = std::vector<vertex>{};
+    auto points   = std::vector<detail::point>{};
+    vertices.reserve(_sides);
+    points.reserve(_sides);
 
     for (auto t = 0.; t < 2 * std::numbers::pi; t += theta) {
-        auto const new_x_p = x_p + len * std::sin(theta_0 + t);
-        auto const new_y_p = y_p + len * std::cos(theta_0 + t);
+        vertices.push_back({static_cast<int_fast32_t>(x_p), static_cast<int_fast32_t>(y_p)});
+        points.push_back({static_cast<float>(x_p), static_cast<float>(y_p)});
+        x_p += len * std::sin(theta_0 + t);
+        y_p += len * std::cos(theta_0 + t);
+    }
 
-        segments.emplace_back(
-            vertex{static_cast<int_fast32_t>(x_p),     static_cast<int_fast32_t>(y_p)},
-            vertex{static_cast<int_fast32_t>(new_x_p), static_cast<int_fast32_t>(new_y_p)}
-        );
-        x_p = new_x_p;
-        y_p = new_y_p;
+    if (_anti_aliasing) {
+        detail::fill_polygon_antialiased(img, points, _fill_color, fill_rule::non_zero);
+    } else {
+        detail::fill_polygon(img, vertices, _fill_color, fill_rule::non_zero);
+    }
+
+    for (auto i = std::size_t{0}; i < vertices.size(); ++i) {
+        auto const next = vertices[(i + 1) % vertices.size()];
+        img.draw(spl::graphics::line{vertices[i], next, _border_color, _anti_aliasing });
     }
+}
 
-    detail::draw_filled(img, segments, _fill_color);
+auto polygon::bounding_box() const noexcept
+    -> graphics::bounding_box
+{
+    if (_vertices.empty()) {
+        return {};
+    }
+    auto const [x_min, x_max] = std::ranges::minmax(_vertices, std::less{}, &vertex::x);
+    auto const [y_min, y_max] = std::ranges::minmax(_vertices, std::less{}, &vertex::y);
+    // the anti-aliased border spreads by a pixel
+    return {x_min.x - 1, y_min.y - 1, x_max.x + 2, y_max.y + 2};
+}
 
-    for (auto const & [v1, v2] : segments) {
-        img.draw(spl::graphics::line{v1, v2, _border_color, _anti_aliasing });
+void polygon::render_on(viewport img) const noexcept
+{
+    detail::fill_vertices(img, _vertices, _fill_color, _rule, _anti_aliasing);
+    if (_border_color.a == 0 or _vertices.size() < 2) {
+        return;
+    }
+    for (auto i = std::size_t{0}; i < _vertices.size(); ++i) {
+        auto const next = _vertices[(i + 1) % _vertices.size()];
+        img.draw(line{_vertices[i], next, _border_color, _anti_aliasing});
+    }
+}
+
+auto polyline::bounding_box() const noexcept
+    -> graphics::bounding_box
+{
+    if (_points.empty()) {
+        return {};
+    }
+    auto const [x_min, x_max] = std::ranges::minmax(_points, std::less{}, &vertex::x);
+    auto const [y_min, y_max] = std::ranges::minmax(_points, std::less{}, &vertex::y);
+    auto const spread = _thickness / 2.f * (_join == line_join::miter ? miter_limit : 1.f);
+    auto const reach  = static_cast<int_fast32_t>(std::ceil(spread)) + 1;
+    return {x_min.x - reach, y_min.y - reach, x_max.x + reach + 1, y_max.y + reach + 1};
+}
+
+void polyline::render_on(viewport img) const noexcept
+{
+    if (_points.empty() or _thickness <= 0 or _color.a == 0) {
+        return;
+    }
+    if (_thickness == 1) {
+        _draw_thin(img);
+    } else {
+        _draw_thick(img);
+    }
+}
+
+void polyline::_draw_thin(viewport img) const noexcept
+{
+    auto const clip = img.clip_box();
+    auto const mode = img.blending();
+    auto const blend = [&](int_fast32_t const x, int_fast32_t const y) {
+        auto & pixel = img.pixel_unchecked(x, y);
+        pixel = over(_color, pixel, mode);
+    };
+    auto const blend_coverage = [&](int_fast32_t const x, int_fast32_t const y, uint8_t const coverage) {
+        auto & pixel = img.pixel_unchecked(x, y);
+        pixel = over(_color.blend(coverage), pixel, mode);
+    };
+
+    if (_points.size() == 1) {
+        if (clip.contains(_points.front().x, _points.front().y)) {
+            blend(_points.front().x, _points.front().y);
+        }
+        return;
+    }
+    // every segment but the first leaves out its first pixel, drawn by the previous one
+    auto skip_first = false;
+    for (auto i = std::size_t{1}; i < _points.size(); ++i) {
+        auto const from = _points[i - 1];
+        auto const to   = _points[i];
+        if (from.x == to.x and from.y == to.y) {
+            continue;
+        }
+        auto const misses = std::max(from.x, to.x) < clip.x0 - 1 or std::min(from.x, to.x) > clip.x1
+                         or std::max(from.y, to.y) < clip.y0 - 1 or std::min(from.y, to.y) > clip.y1;
+        if (not misses) {
+            if (_anti_aliasing) {
+                detail::walk_wu(from, to, clip, skip_first, blend_coverage);
+            } else {
+                detail::walk_bresenham(from, to, clip, skip_first, blend);
+            }
+        }
+        skip_first = true;
+    }
+}
+
+void polyline::_draw_thick(viewport img) const noexcept
+{
+    using detail::point;
+
+    // every segment is a quad and every corner a wedge; turned all the same way, they merge
+    // with the non-zero rule and each pixel is blended once
+    auto points = std::vector<point>{};
+    points.reserve(_points.size());
+    for (auto const v : _points) {
+        auto const p = point{static_cast<float>(v.x), static_cast<float>(v.y)};
+        if (points.empty() or points.back().x != p.x or points.back().y != p.y) {
+            points.push_back(p);
+        }
+    }
+    if (points.size() < 2) {
+        return;
+    }
+
+    auto const radius = _thickness / 2.f;
+    auto const clip   = img.clip_box();
+    auto const reach  = radius * (_join == line_join::miter ? miter_limit : 1.f) + 2.f;
+    auto const near   = [&](point const a, point const b) {
+        return std::max(a.x, b.x) + reach >= clip.x0 and std::min(a.x, b.x) - reach < clip.x1
+           and std::max(a.y, b.y) + reach >= clip.y0 and std::min(a.y, b.y) - reach < clip.y1;
+    };
+
+    auto edges = std::vector<std::pair<point, point>>{};
+    edges.reserve(7 * points.size());
+    auto const add_contour = [&edges](std::initializer_list<point> const contour) {
+        auto const n = contour.size();
+        auto const * const c = contour.begin();
+        auto area = 0.f;
+        for (auto i = std::size_t{0}; i < n; ++i) {
+            area += c[i].x * c[(i + 1) % n].y - c[(i + 1) % n].x * c[i].y;
+        }
+        for (auto i = std::size_t{0}; i < n; ++i) {
+            auto const & a = c[i];
+            auto const & b = c[(i + 1) % n];
+            edges.push_back(area <= 0 ? std::pair{a, b} : std::pair{b, a});
+        }
+    };
+
+    auto normals = std::vector<point>(points.size() - 1);
+    for (auto i = std::size_t{0}; i + 1 < points.size(); ++i) {
+        auto const dx = points[i + 1].x - points[i].x;
+        auto const dy = points[i + 1].y - points[i].y;
+        auto const length = std::hypot(dx, dy);
+        normals[i] = {-dy / length, dx / length};
+    }
+    auto const offset = [radius](point const p, point const n, float const k = 1.f) {
+        return point{p.x + n.x * radius * k, p.y + n.y * radius * k};
+    };
+
+    for (auto i = std::size_t{0}; i + 1 < points.size(); ++i) {
+        auto const p = points[i];
+        auto const q = points[i + 1];
+        auto const n = normals[i];
+        if (near(p, q)) {
+            add_contour({offset(p, n), offset(q, n), offset(q, n, -1.f), offset(p, n, -1.f)});
+        }
+    }
+
+    // a chord every few degrees, so that it is never farther than a quarter of pixel from the arc
+    auto const arc_step = 2 * std::acos(std::max(1.f - 0.25f / radius, -1.f));
+    for (auto i = std::size_t{1}; i + 1 < points.size(); ++i) {
+        auto const p = points[i];
+        auto const na = normals[i - 1];
+        auto const nb = normals[i];
+        auto const cross = na.x * nb.y - na.y * nb.x;
+        if (std::abs(cross) < 1e-6f and na.x * nb.x + na.y * nb.y > 0) {
+            continue;
+        }
+        if (not near(p, p)) {
+            continue;
+        }
+        // the corner opens on the side opposite to the turn
+        auto const side = cross > 0 ? -1.f : 1.f;
+        auto const a = offset(p, na, side);
+        auto const b = offset(p, nb, side);
+        switch (_join) {
+        case line_join::miter: {
+            auto const mx = na.x + nb.x;
+            auto const my = na.y + nb.y;
+            auto const m_length = std::hypot(mx, my);
+            // the miter is 1 / cos(half the angle) times the radius
+            auto const cos_half = m_length / 2;
+            if (cos_half * miter_limit >= 1.f) {
+                auto const tip = offset(p, {mx / m_length, my / m_length}, side / cos_half);
+                add_contour({p, a, tip, b});
+                break;
+            }
+            add_contour({p, a, b});
+            break;
+        }
+        case line_join::bevel:
+            add_contour({p, a, b});
+            break;
+        case line_join::round: {
+            auto const from  = std::atan2(a.y - p.y, a.x - p.x);
+            auto delta = std::atan2(b.y - p.y, b.x - p.x) - from;
+            delta -= std::round(delta / (2 * std::numbers::pi_v<float>)) * 2 * std::numbers::pi_v<float>;
+            auto const chords = std::clamp(static_cast<int>(std::ceil(std::abs(delta) / arc_step)), 1, 64);
+            auto previous = a;
+            for (auto k = 1; k <= chords; ++k) {
+                auto const angle = from + delta * static_cast<float>(k) / static_cast<float>(chords);
+                auto const next = k == chords ? b : point{p.x + radius * std::cos(angle), p.y + radius * std::sin(angle)};
+                add_contour({p, previous, next});
+                previous = next;
+            }
+            break;
+        }
+        }
+    }
+
+    detail::fill_edges(img, edges, _color, fill_rule::non_zero, _anti_aliasing);
+}
+
+time_series::time_series(std::span<double const> const x, std::span<double const> const y, rgba const color, bool const antialiasing) :
+    _x{x}, _y{y}, _color{color}, _anti_aliasing{antialiasing}
+{
+    if (x.size() != y.size()) {
+        throw spl::invalid_argument{"'time_series' requires as many x as y"};
+    }
+}
+
+auto time_series::x_range(double const lo, double const hi)
+    -> time_series &
+{
+    if (not (lo < hi)) {
+        throw spl::invalid_argument{"'time_series::x_range' requires lo < hi"};
+    }
+    _x_range.emplace(lo, hi);
+    return *this;
+}
+
+auto time_series::y_range(double const lo, double const hi)
+    -> time_series &
+{
+    if (not (lo < hi)) {
+        throw spl::invalid_argument{"'time_series::y_range' requires lo < hi"};
+    }
+    _y_range.emplace(lo, hi);
+    return *this;
+}
+
+auto time_series::decimate(int_fast32_t const width, int_fast32_t const height) const
+    -> std::vector<vertex>
+{
+    if (_x.empty() or width <= 0 or height <= 0) {
+        return {};
+    }
+
+    // a range of a single value is centered
+    auto const widen = [](double const lo, double const hi) {
+        return lo < hi ? std::pair{lo, hi} : std::pair{lo - 0.5, hi + 0.5};
+    };
+    auto const [x_lo, x_hi] = _x_range.value_or(widen(_x.front(), _x.back()));
+    auto const [y_lo, y_hi] = _y_range ? *_y_range : [&] {
+        auto lo = _y.front();
+        auto hi = _y.front();
+        for (auto const y : _y) {
+            lo = std::min(lo, y);
+            hi = std::max(hi, y);
+        }
+        return widen(lo, hi);
+    }();
+    auto const x_scale = static_cast<double>(width - 1) / (x_hi - x_lo);
+    auto const y_scale = static_cast<double>(height - 1) / (y_hi - y_lo);
+
+    // the pixel of a sample, kept far enough from the limits of `int_fast32_t` for the clipping
+    auto const snap = [](double const v) {
+        constexpr auto limit = double{1 << 30};
+        return static_cast<int_fast32_t>(std::floor(std::clamp(v, -limit, limit) + 0.5));
+    };
+    auto const column = [&](double const x) { return snap((x - x_lo) * x_scale); };
+    auto const row    = [&](double const y) { return snap((y_hi - y) * y_scale); };
+
+    auto result = std::vector<vertex>{};
+    auto const push = [&result](int_fast32_t const x, int_fast32_t const y) {
+        if (result.empty() or result.back().x != x or result.back().y != y) {
+            result.push_back({x, y});
+        }
+    };
+
+    // `column` never decreases with `x`, so the samples of every column are contiguous
+    auto const n = _x.size();
+    auto const first_with = [&](std::size_t const from, auto const pred) {
+        auto const it = std::partition_point(_x.begin() + static_cast<std::ptrdiff_t>(from), _x.end(), pred);
+        return static_cast<std::size_t>(it - _x.begin());
+    };
+    auto i = first_with(0, [&](double const x) { return column(x) < 0; });
+    if (i > 0) {
+        push(column(_x[i - 1]), row(_y[i - 1]));
+    }
+    while (i < n) {
+        auto const c = column(_x[i]);
+        if (c >= width) {
+            break;
+        }
+        auto const end = first_with(i, [&](double const x) { return column(x) <= c; });
+        if (end - i <= 4) {
+            for (auto j = i; j < end; ++j) {
+                push(c, row(_y[j]));
+            }
+            i = end;
+            continue;
+        }
+
+        auto lo = _y[i];
+        auto hi = _y[i];
+        for (auto j = i + 1; j < end; ++j) {
+            lo = std::min(lo, _y[j]);
+            hi = std::max(hi, _y[j]);
+        }
+        // both extremes are in the same column, so their order does not change the pixels; the
+        // closest to the first sample comes first to keep the path short
+        auto const first = row(_y[i]);
+        auto const last  = row(_y[end - 1]);
+        auto near = row(hi);
+        auto far  = row(lo);
+        if (std::abs(far - first) < std::abs(near - first)) {
+            std::swap(near, far);
+        }
+        push(c, first);
+        push(c, near);
+        push(c, far);
+        push(c, last);
+        i = end;
+    }
+    if (i < n) {
+        push(column(_x[i]), row(_y[i]));
+    }
+    return result;
+}
+
+void time_series::render_on(viewport img) const noexcept
+{
+    if (_x.empty() or _thickness <= 0 or _color.a == 0) {
+        return;
     }
+    auto const width  = static_cast<int_fast32_t>(img.width());
+    auto const height = static_cast<int_fast32_t>(img.height());
+    polyline{decimate(width, height), _color, _anti_aliasing}.thickness(_thickness).render_on(img);
 }
 
 void circle::_draw_unfilled(viewport img) const noexcept
@@ -0,0 +1,425 @@
+/**
+ * @author      : rbrugo, momokrono
+ * @file        : rgba.cpp
+ * @created     : Saturday Oct 17, 2026 10:12:40 CEST
+ * @license     : MIT
+ */
+
+#include "spl/rgba.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+#if defined(__SSE2__) and defined(__GNUC__)
+#define SPL_OVER_SPAN_X86
+#include <immintrin.h>
+#endif
+
+namespace spl::graphics
+{
+
+namespace detail
+{
+constexpr
+auto _make_gamma_to_linear() noexcept
+{
+    auto table = std::array<uint16_t, 256>{};
+    for (uint32_t c = 0; c < table.size(); ++c) {
+        table[c] = static_cast<uint16_t>(c * c);
+    }
+    return table;
+}
+
+constexpr
+auto _make_linear_to_gamma() noexcept
+{
+    auto table = std::array<uint8_t, 65536>{};
+    uint32_t root = 0;
+    for (uint32_t l = 0; l < table.size(); ++l) {
+        while ((root + 1) * (root + 1) <= l) {
+            ++root;
+        }
+        table[l] = static_cast<uint8_t>(root);
+    }
+    return table;
+}
+
+constinit std::array<uint16_t, 256> const gamma_to_linear = _make_gamma_to_linear();
+constinit std::array<uint8_t, 65536> const linear_to_gamma = _make_linear_to_gamma();
+} // namespace detail
+
+namespace
+{
+// Every kernel composes `n` pixels over `bg`. The foreground is taken from `fg` if not null,
+// otherwise it is `color`, with the alpha scaled by `coverage` if the latter is not null.
+using over_kernel = void (*)(rgba const * fg, rgba color, uint8_t const * coverage, rgba * bg, size_t n) noexcept;
+
+template <blend_mode Mode>
+void _over_scalar(rgba const * fg, rgba const color, uint8_t const * coverage, rgba * bg, size_t const n) noexcept
+{
+    for (size_t i = 0; i < n; ++i) {
+        auto const src = fg ? fg[i] : coverage ? color.blend(coverage[i]) : color;
+        bg[i] = over(src, bg[i], Mode);
+    }
+}
+
+#ifdef SPL_OVER_SPAN_X86
+// The vector kernels perform exactly the same float operations, in the same order, of the scalar
+// `over_gamma` and `over_no_gamma`, so the results are bit-identical. The lookup tables of
+// `over_lut` are not vectorized, as gathers are slower than the scalar loads.
+// The premultiplied kernels work on 16 bit lanes, two pixels per 128 bits, using the same integer
+// arithmetic of `premultiply` and `over_premul`.
+
+/// `x * y / 255` rounded on 16 bit lanes, like `detail::mul_div255`
+inline
+auto _mul_div255_sse2(__m128i const x, __m128i const y) noexcept
+{
+    auto const t = _mm_add_epi16(_mm_mullo_epi16(x, y), _mm_set1_epi16(128));
+    return _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+}
+
+/// Broadcasts the alpha of both pixels in a 16 bit lanes vector to their channels
+inline
+auto _alpha16_sse2(__m128i const px) noexcept
+{ return _mm_shufflehi_epi16(_mm_shufflelo_epi16(px, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3)); }
+
+inline
+auto _premultiply2_sse2(__m128i const px) noexcept
+{
+    // the alpha lane is multiplied by 255, which leaves it unchanged
+    auto const alpha_lanes = _mm_set_epi16(-1, 0, 0, 0, -1, 0, 0, 0);
+    auto const k = _mm_or_si128(_mm_andnot_si128(alpha_lanes, _alpha16_sse2(px)), _mm_srli_epi16(alpha_lanes, 8));
+    return _mul_div255_sse2(px, k);
+}
+
+inline
+auto _over2_premul_sse2(__m128i const fg, __m128i const bg) noexcept
+{
+    auto const k = _mm_sub_epi16(_mm_set1_epi16(255), _alpha16_sse2(fg));
+    return _mm_add_epi16(fg, _mul_div255_sse2(bg, k));
+}
+
+/// Composes 4 premultiplied pixels; the foreground is premultiplied first if `Straight`
+template <bool Straight>
+inline
+auto _over4_premul_sse2(__m128i const fg, __m128i const bg) noexcept
+    -> __m128i
+{
+    auto const zero = _mm_setzero_si128();
+    auto fg_lo = _mm_unpacklo_epi8(fg, zero);
+    auto fg_hi = _mm_unpackhi_epi8(fg, zero);
+    if constexpr (Straight) {
+        fg_lo = _premultiply2_sse2(fg_lo);
+        fg_hi = _premultiply2_sse2(fg_hi);
+    }
+    return _mm_packus_epi16(
+        _over2_premul_sse2(fg_lo, _mm_unpacklo_epi8(bg, zero)),
+        _over2_premul_sse2(fg_hi, _mm_unpackhi_epi8(bg, zero))
+    );
+}
+
+template <int Shift>
+inline
+auto _channel_sse2(__m128i const px) noexcept
+{ return _mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(px, Shift), _mm_set1_epi32(0xff))); }
+
+template <blend_mode Mode>
+inline
+auto _over4_sse2(__m128i const fg, __m128i const bg) noexcept
+    -> __m128i
+{
+    if constexpr (Mode == blend_mode::premultiplied) {
+        return _over4_premul_sse2<true>(fg, bg);
+    }
+    constexpr auto Gamma = Mode == blend_mode::gamma;
+    auto const v255 = _mm_set1_ps(255.f);
+    auto const k1 = _mm_div_ps(_channel_sse2<24>(fg), v255);
+    auto const k2 = _mm_div_ps(_mm_mul_ps(_mm_sub_ps(_mm_set1_ps(1.f), k1), _channel_sse2<24>(bg)), v255);
+    auto const k  = _mm_add_ps(k1, k2);
+
+    auto const compose = [k1, k2, k](__m128 const c1, __m128 const c2) noexcept {
+        if constexpr (Gamma) {
+            auto const num = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(c1, c1), k1), _mm_mul_ps(_mm_mul_ps(c2, c2), k2));
+            return _mm_cvttps_epi32(_mm_sqrt_ps(_mm_div_ps(num, k)));
+        } else {
+            auto const num = _mm_add_ps(_mm_mul_ps(c1, k1), _mm_mul_ps(c2, k2));
+            return _mm_cvttps_epi32(_mm_div_ps(num, k));
+        }
+    };
+
+    // a fully transparent result gives NaNs, which are converted to 0x80000000: mask them out
+    auto const mask = _mm_set1_epi32(0xff);
+    auto const r = _mm_and_si128(compose(_channel_sse2<0>(fg),  _channel_sse2<0>(bg)),  mask);
+    auto const g = _mm_and_si128(compose(_channel_sse2<8>(fg),  _channel_sse2<8>(bg)),  mask);
+    auto const b = _mm_and_si128(compose(_channel_sse2<16>(fg), _channel_sse2<16>(bg)), mask);
+    auto const a = _mm_and_si128(_mm_cvttps_epi32(_mm_mul_ps(k, v255)), mask);
+
+    return _mm_or_si128(
+        _mm_or_si128(r, _mm_slli_epi32(g, 8)),
+        _mm_or_si128(_mm_slli_epi32(b, 16), _mm_slli_epi32(a, 24))
+    );
+}
+
+template <blend_mode Mode>
+void _over_sse2(rgba const * fg, rgba const color, uint8_t const * coverage, rgba * bg, size_t const n) noexcept
+{
+    auto const color_px = _mm_set1_epi32(std::bit_cast<int32_t>(color));
+    auto const color_rgb = _mm_and_si128(color_px, _mm_set1_epi32(0x00ffffff));
+    auto const color_a = _mm_set1_ps(color.a);
+
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        auto src = color_px;
+        if (fg) {
+            src = _mm_loadu_si128(reinterpret_cast<__m128i const *>(fg + i));
+        } else if (coverage) {
+            auto const zero = _mm_setzero_si128();
+            auto cov = _mm_cvtsi32_si128(0);
+            std::memcpy(&cov, coverage + i, 4);
+            cov = _mm_unpacklo_epi16(_mm_unpacklo_epi8(cov, zero), zero);
+            auto const alpha = _mm_cvttps_epi32(
+                _mm_mul_ps(_mm_div_ps(_mm_cvtepi32_ps(cov), _mm_set1_ps(255.f)), color_a)
+            );
+            src = _mm_or_si128(color_rgb, _mm_slli_epi32(alpha, 24));
+        }
+        auto * dst = reinterpret_cast<__m128i *>(bg + i);
+        _mm_storeu_si128(dst, _over4_sse2<Mode>(src, _mm_loadu_si128(dst)));
+    }
+    _over_scalar<Mode>(fg ? fg + i : nullptr, color, coverage ? coverage + i : nullptr, bg + i, n - i);
+}
+
+[[gnu::target("avx2")]] inline
+auto _mul_div255_avx2(__m256i const x, __m256i const y) noexcept
+{
+    auto const t = _mm256_add_epi16(_mm256_mullo_epi16(x, y), _mm256_set1_epi16(128));
+    return _mm256_srli_epi16(_mm256_add_epi16(t, _mm256_srli_epi16(t, 8)), 8);
+}
+
+[[gnu::target("avx2")]] inline
+auto _alpha16_avx2(__m256i const px) noexcept
+{
+    return _mm256_shufflehi_epi16(
+        _mm256_shufflelo_epi16(px, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3)
+    );
+}
+
+[[gnu::target("avx2")]] inline
+auto _premultiply4_avx2(__m256i const px) noexcept
+{
+    auto const alpha_lanes = _mm256_set1_epi64x(int64_t{-1} << 48);
+    auto const k = _mm256_or_si256(
+        _mm256_andnot_si256(alpha_lanes, _alpha16_avx2(px)), _mm256_srli_epi16(alpha_lanes, 8)
+    );
+    return _mul_div255_avx2(px, k);
+}
+
+[[gnu::target("avx2")]] inline
+auto _over4_premul_avx2(__m256i const fg, __m256i const bg) noexcept
+{
+    auto const k = _mm256_sub_epi16(_mm256_set1_epi16(255), _alpha16_avx2(fg));
+    return _mm256_add_epi16(fg, _mul_div255_avx2(bg, k));
+}
+
+template <bool Straight>
+[[gnu::target("avx2")]] inline
+auto _over8_premul_avx2(__m256i const fg, __m256i const bg) noexcept
+    -> __m256i
+{
+    // unpacking and packing both work inside the 128 bit halves, so the pixel order is preserved
+    auto const zero = _mm256_setzero_si256();
+    auto fg_lo = _mm256_unpacklo_epi8(fg, zero);
+    auto fg_hi = _mm256_unpackhi_epi8(fg, zero);
+    if constexpr (Straight) {
+        fg_lo = _premultiply4_avx2(fg_lo);
+        fg_hi = _premultiply4_avx2(fg_hi);
+    }
+    return _mm256_packus_epi16(
+        _over4_premul_avx2(fg_lo, _mm256_unpacklo_epi8(bg, zero)),
+        _over4_premul_avx2(fg_hi, _mm256_unpackhi_epi8(bg, zero))
+    );
+}
+
+template <int Shift>
+[[gnu::target("avx2")]] inline
+auto _channel_avx2(__m256i const px) noexcept
+{ return _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srli_epi32(px, Shift), _mm256_set1_epi32(0xff))); }
+
+// lambdas do not inherit the target of the enclosing function, hence a named function
+template <bool Gamma>
+[[gnu::target("avx2")]] inline
+auto _compose_avx2(__m256 const c1, __m256 const c2, __m256 const k1, __m256 const k2, __m256 const k) noexcept
+{
+    if constexpr (Gamma) {
+        auto const num = _mm256_add_ps(
+            _mm256_mul_ps(_mm256_mul_ps(c1, c1), k1), _mm256_mul_ps(_mm256_mul_ps(c2, c2), k2)
+        );
+        return _mm256_cvttps_epi32(_mm256_sqrt_ps(_mm256_div_ps(num, k)));
+    } else {
+        auto const num = _mm256_add_ps(_mm256_mul_ps(c1, k1), _mm256_mul_ps(c2, k2));
+        return _mm256_cvttps_epi32(_mm256_div_ps(num, k));
+    }
+}
+
+template <blend_mode Mode>
+[[gnu::target("avx2")]] inline
+auto _over8_avx2(__m256i const fg, __m256i const bg) noexcept
+    -> __m256i
+{
+    if constexpr (Mode == blend_mode::premultiplied) {
+        return _over8_premul_avx2<true>(fg, bg);
+    }
+    constexpr auto Gamma = Mode == blend_mode::gamma;
+    auto const v255 = _mm256_set1_ps(255.f);
+    auto const k1 = _mm256_div_ps(_channel_avx2<24>(fg), v255);
+    auto const k2 = _mm256_div_ps(_mm256_mul_ps(_mm256_sub_ps(_mm256_set1_ps(1.f), k1), _channel_avx2<24>(bg)), v255);
+    auto const k  = _mm256_add_ps(k1, k2);
+
+    auto const mask = _mm256_set1_epi32(0xff);
+    auto const r = _mm256_and_si256(_compose_avx2<Gamma>(_channel_avx2<0>(fg),  _channel_avx2<0>(bg),  k1, k2, k), mask);
+    auto const g = _mm256_and_si256(_compose_avx2<Gamma>(_channel_avx2<8>(fg),  _channel_avx2<8>(bg),  k1, k2, k), mask);
+    auto const b = _mm256_and_si256(_compose_avx2<Gamma>(_channel_avx2<16>(fg), _channel_avx2<16>(bg), k1, k2, k), mask);
+    auto const a = _mm256_and_si256(_mm256_cvttps_epi32(_mm256_mul_ps(k, v255)), mask);
+
+    return _mm256_or_si256(
+        _mm256_or_si256(r, _mm256_slli_epi32(g, 8)),
+        _mm256_or_si256(_mm256_slli_epi32(b, 16), _mm256_slli_epi32(a, 24))
+    );
+}
+
+template <blend_mode Mode>
+[[gnu::target("avx2")]]
+void _over_avx2(rgba const * fg, rgba const color, uint8_t const * coverage, rgba * bg, size_t const n) noexcept
+{
+    auto const color_px = _mm256_set1_epi32(std::bit_cast<int32_t>(color));
+    auto const color_rgb = _mm256_and_si256(color_px, _mm256_set1_epi32(0x00ffffff));
+    auto const color_a = _mm256_set1_ps(color.a);
+
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        auto src = color_px;
+        if (fg) {
+            src = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(fg + i));
+        } else if (coverage) {
+            auto const cov = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<__m128i const *>(coverage + i)));
+            auto const alpha = _mm256_cvttps_epi32(
+                _mm256_mul_ps(_mm256_div_ps(_mm256_cvtepi32_ps(cov), _mm256_set1_ps(255.f)), color_a)
+            );
+            src = _mm256_or_si256(color_rgb, _mm256_slli_epi32(alpha, 24));
+        }
+        auto * dst = reinterpret_cast<__m256i *>(bg + i);
+        _mm256_storeu_si256(dst, _over8_avx2<Mode>(src, _mm256_loadu_si256(dst)));
+    }
+    _over_sse2<Mode>(fg ? fg + i : nullptr, color, coverage ? coverage + i : nullptr, bg + i, n - i);
+}
+#endif // SPL_OVER_SPAN_X86
+
+// Composes `n` premultiplied pixels of `fg` over `bg`
+using over_premul_kernel = void (*)(rgba_premul const * fg, rgba_premul * bg, size_t n) noexcept;
+
+void _over_premul_scalar(rgba_premul const * fg, rgba_premul * bg, size_t const n) noexcept
+{
+    for (size_t i = 0; i < n; ++i) {
+        bg[i] = over_premul(fg[i], bg[i]);
+    }
+}
+
+#ifdef SPL_OVER_SPAN_X86
+void _over_premul_sse2(rgba_premul const * fg, rgba_premul * bg, size_t const n) noexcept
+{
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        auto const src = _mm_loadu_si128(reinterpret_cast<__m128i const *>(fg + i));
+        auto * dst = reinterpret_cast<__m128i *>(bg + i);
+        _mm_storeu_si128(dst, _over4_premul_sse2<false>(src, _mm_loadu_si128(dst)));
+    }
+    _over_premul_scalar(fg + i, bg + i, n - i);
+}
+
+[[gnu::target("avx2")]]
+void _over_premul_avx2(rgba_premul const * fg, rgba_premul * bg, size_t const n) noexcept
+{
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        auto const src = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(fg + i));
+        auto * dst = reinterpret_cast<__m256i *>(bg + i);
+        _mm256_storeu_si256(dst, _over8_premul_avx2<false>(src, _mm256_loadu_si256(dst)));
+    }
+    _over_premul_sse2(fg + i, bg + i, n - i);
+}
+#endif // SPL_OVER_SPAN_X86
+
+/// Selects the widest kernel supported by the running CPU
+template <blend_mode Mode>
+auto _select_over_kernel() noexcept
+    -> over_kernel
+{
+#ifdef SPL_OVER_SPAN_X86
+    if (__builtin_cpu_supports("avx2")) {
+        return &_over_avx2<Mode>;
+    }
+    return &_over_sse2<Mode>;
+#else
+    return &_over_scalar<Mode>;
+#endif
+}
+
+auto _select_over_premul_kernel() noexcept
+    -> over_premul_kernel
+{
+#ifdef SPL_OVER_SPAN_X86
+    if (__builtin_cpu_supports("avx2")) {
+        return &_over_premul_avx2;
+    }
+    return &_over_premul_sse2;
+#else
+    return &_over_premul_scalar;
+#endif
+}
+
+void _over_dispatch(
+    rgba const * fg, rgba const color, uint8_t const * coverage, rgba * bg, size_t const n, blend_mode const mode
+) noexcept
+{
+    static auto const no_gamma_kernel = _select_over_kernel<blend_mode::no_gamma>();
+    static auto const gamma_kernel    = _select_over_kernel<blend_mode::gamma>();
+    static auto const premul_kernel   = _select_over_kernel<blend_mode::premultiplied>();
+    switch (mode) {
+    case blend_mode::no_gamma:      no_gamma_kernel(fg, color, coverage, bg, n); break;
+    case blend_mode::gamma:         gamma_kernel(fg, color, coverage, bg, n); break;
+    case blend_mode::gamma_lut:     _over_scalar<blend_mode::gamma_lut>(fg, color, coverage, bg, n); break;
+    case blend_mode::premultiplied: premul_kernel(fg, color, coverage, bg, n); break;
+    }
+}
+} // namespace
+
+void over_span(rgba const foreground, std::span<rgba> background, blend_mode const mode) noexcept
+{
+    if (foreground.a == 255) {
+        std::ranges::fill(background, foreground);
+        return;
+    }
+    _over_dispatch(nullptr, foreground, nullptr, background.data(), background.size(), mode);
+}
+
+void over_span(
+    rgba const foreground, std::span<uint8_t const> coverage, std::span<rgba> background, blend_mode const mode
+) noexcept
+{
+    auto const n = std::min(coverage.size(), background.size());
+    _over_dispatch(nullptr, foreground, coverage.data(), background.data(), n, mode);
+}
+
+void over_span(std::span<rgba const> foreground, std::span<rgba> background, blend_mode const mode) noexcept
+{
+    auto const n = std::min(foreground.size(), background.size());
+    _over_dispatch(foreground.data(), {}, nullptr, background.data(), n, mode);
+}
+
+void over_span(std::span<rgba_premul const> foreground, std::span<rgba_premul> background) noexcept
+{
+    static auto const kernel = _select_over_premul_kernel();
+    kernel(foreground.data(), background.data(), std::min(foreground.size(), background.size()));
+}
+
+} // namespace spl::graphics
@@ -5,10 +5,15 @@
  * @description : implements the functionalities of the text class, used to render text on an image
  */
 
-#include <fstream>
+#include <algorithm>
+#include <bit>
+#include <map>
+#include <mutex>
 
 #include "stb_truetype.h"
 #include "spl/text.hpp"
+#include "spl/detail/glyph_cache.hpp"
+#include "spl/detail/mapped_file.hpp"
 
 namespace spl::graphics
 {
@@ -20,31 +25,47 @@ class font_face_impl
     friend class spl::graphics::font_face;
     friend std::shared_ptr<font_face_impl> load_from_file(std::filesystem::path const &);
 
+    spl::detail::mapped_file _file;
     stbtt_fontinfo _info;
-    std::vector<unsigned char> _buffer;
+    spl::detail::glyph_cache _glyphs;
 
-    font_face_impl() = default;
+    explicit font_face_impl(spl::detail::mapped_file file) : _file{std::move(file)} {}
 
 };
 
+/// Every face loaded from the same file, while any of them is alive, shares the mapping and the
+/// glyphs; the files are told apart by their canonical path
 auto load_from_file(std::filesystem::path const & source)
     -> std::shared_ptr<font_face_impl>
 {
-    if (not std::filesystem::exists(source)) {
+    auto ec = std::error_code{};
+    auto const path = std::filesystem::canonical(source, ec);
+    if (ec) {
         throw font_error(fmt::format("font \"{}\" not found", source.native()));
     }
-    auto res = std::shared_ptr<font_face_impl>(new font_face_impl);
-    {
-        auto in = std::ifstream{source, std::ios::in | std::ios::binary | std::ios::ate};
-        auto const font_size = in.tellg();
-        in.seekg(0, std::ios::beg);
-        res->_buffer.resize(font_size);
-        in.read(reinterpret_cast<char *>(res->_buffer.data()), font_size);
+
+    static auto registry_mutex = std::mutex{};
+    static auto registry = std::map<std::filesystem::path, std::weak_ptr<font_face_impl>>{};
+    auto const lock = std::scoped_lock{registry_mutex};
+    if (auto const it = registry.find(path); it != registry.end()) {
+        if (auto face = it->second.lock()) {
+            return face;
+        }
     }
-    auto ec = stbtt_InitFont(&res->_info, res->_buffer.data(), 0);
-    if (ec == 0) {
+
+    // the glyphs are looked up all over the file, reading ahead would only evict other pages
+    auto file = spl::detail::mapped_file::open(path, spl::detail::mapped_file::access_pattern::random);
+    if (not file) {
+        throw font_error(fmt::format("font \"{}\" cannot be read", source.native()));
+    }
+    auto res = std::shared_ptr<font_face_impl>(new font_face_impl{std::move(*file)});
+    auto const bytes = res->_file.bytes();
+    auto const * const data = reinterpret_cast<unsigned char const *>(bytes.data());
+    if (bytes.size() < 12 or stbtt_InitFont(&res->_info, data, 0) == 0) {
         throw font_error(fmt::format("unexpected error while reading the font \"{}\"", source.native()));
     }
+    std::erase_if(registry, [](auto const & entry) { return entry.second.expired(); });
+    registry.insert_or_assign(path, res);
     return res;
 }
 
@@ -52,6 +73,8 @@ auto load_from_file(std::filesystem::path const & source)
 
 auto font_face::face_info() const -> decltype(auto) { return std::addressof(_impl->_info); }
 auto font::face_info()      const -> decltype(auto) { return _face.face_info(); }
+auto font_face::glyphs() const -> spl::detail::glyph_cache & { return _impl->_glyphs; }
+auto font::glyphs()      const -> spl::detail::glyph_cache & { return _face.glyphs(); }
 
 namespace detail
 {
@@ -107,6 +130,12 @@ auto parse_codepoints(std::string_view text)
     return res;
 }
 
+/// The distance fields are made at this height, and extend this far out of the glyphs
+constexpr auto field_height  = 48.f;
+constexpr auto field_padding = 12;
+/// The value of the field on the border of the glyph; the highest one is inside
+constexpr auto field_edge    = 128.f;
+
 struct stb_deleter
 {
     template <typename T>
@@ -116,50 +145,242 @@ struct stb_deleter
 };
 } // namespace detail
 
-void text::render_on(viewport img) const noexcept
+text_run::text_run(std::string_view const text, font const & f) :
+    _font{f}
 {
+    auto const * const info = _font.face_info();
+    auto const scale = stbtt_ScaleForPixelHeight(info, _font._height);
+    auto const steps = spl::detail::glyph_cache::subpixel_steps;
+    auto [ascent, descent, line_gap] = std::array{0, 0, 0};
+    stbtt_GetFontVMetrics(info, &ascent, &descent, &line_gap);
+    _line_height = static_cast<int32_t>(std::lround(static_cast<float>(ascent - descent + line_gap) * scale));
 
-    auto [x_pos, advance, lsb, x0, y0, x1, y1] = std::array{0, 0, 0, 0, 0, 0, 0};
-    auto const codepoints = detail::parse_codepoints(_text);
+    auto const codepoints = detail::parse_codepoints(text);
+    _glyphs.reserve(codepoints.size());
+    auto x_pos = 0.f;
+    auto baseline = int32_t{0};
     auto const end = codepoints.end();
-    auto const color = _color;
-    auto const scale = stbtt_ScaleForPixelHeight(_font.face_info(), _font._height);
-    // auto const not_found =  _font._buffer.end();
     for (auto cp_it = codepoints.begin(); cp_it != end; ++cp_it) {
-        auto codepoint = static_cast<int32_t>(*cp_it);
-        auto const x_shift = x_pos - std::floor(x_pos);
-        stbtt_GetCodepointHMetrics(_font.face_info(), codepoint, &advance, &lsb);
-        auto data_it = _font._buffer.find(codepoint);
-        if (data_it == _font._buffer.end()) {
-            auto [width, height, x_off, y_off] = std::array{0, 0, 0, 0};
-            auto data = std::shared_ptr<uint8_t []>(stbtt_GetCodepointBitmapSubpixel(
-                _font.face_info(),  // info
-                scale, scale,       // scale x, y
-                x_shift, 0,         // shift x, y
-                codepoint,          // codepoint (int)
-                &width, &height,    // width, height (out params)
-                &x_off, &y_off      // offset from the top-left corner (out params)
-            ), detail::stb_deleter{});
-            auto [new_it, done] = _font._buffer.try_emplace(codepoint + 0, width, height, x_off, y_off, std::move(data));
-            data_it = new_it;
+        auto const codepoint = *cp_it;
+        if (codepoint == '\n') {
+            _advance = std::max(_advance, x_pos);
+            x_pos = 0.f;
+            baseline += _line_height;
+            ++_lines;
+            continue;
+        }
+
+        // the pen is rounded down to a fraction of pixel, which picks the glyph in the cache
+        auto const pen_x = std::floor(x_pos);
+        auto const shift = std::min(static_cast<int>((x_pos - pen_x) * steps), steps - 1);
+        auto [x0, y0, x1, y1] = std::array{0, 0, 0, 0};
+        stbtt_GetCodepointBitmapBoxSubpixel(
+            info, codepoint, scale, scale, static_cast<float>(shift) / steps, 0, &x0, &y0, &x1, &y1
+        );
+        // the glyphs without pixels, like spaces, only move the pen
+        if (x0 < x1 and y0 < y1) {
+            auto const x = static_cast<int32_t>(pen_x);
+            _glyphs.push_back({
+                codepoint, x, baseline, static_cast<uint8_t>(shift),
+                static_cast<int16_t>(x0), static_cast<int16_t>(y0), static_cast<int16_t>(x1), static_cast<int16_t>(y1)
+            });
+            _box = _box.unite({x + x0, baseline + y0, x + x1, baseline + y1});
+        }
+
+        auto [advance, lsb] = std::array{0, 0};
+        stbtt_GetCodepointHMetrics(info, codepoint, &advance, &lsb);
+        x_pos += static_cast<float>(advance) * scale;
+        if (cp_it + 1 != end and *(cp_it + 1) != '\n') {
+            x_pos += scale * static_cast<float>(stbtt_GetCodepointKernAdvance(info, codepoint, *(cp_it + 1)));
+        }
+    }
+    _advance = std::max(_advance, x_pos);
+}
+
+void text_run::render_on(viewport img, vertex const origin, rgba const color) const noexcept
+{
+    if (_distance_field) {
+        _draw_distance_field(img, origin, color);
+        return;
+    }
+    auto const scale = stbtt_ScaleForPixelHeight(_font.face_info(), _font._height);
+    auto const height_bits = std::bit_cast<uint32_t>(_font._height);
+    auto const steps = spl::detail::glyph_cache::subpixel_steps;
+    auto const clip  = img.clip_box();
+    auto & cache = _font.glyphs();
+
+    // clip the glyph to the drawable area, then compose it a row at a time
+    auto const draw = [&](spl::detail::glyph_bitmap const & glyph, vertex const pen) {
+        auto const left   = pen.x + glyph.x_off;
+        auto const top    = pen.y + glyph.y_off;
+        auto const x_from = std::max<int_fast32_t>(0, clip.x0 - left);
+        auto const x_to   = std::min<int_fast32_t>(glyph.width, clip.x1 - left);
+        auto const y_from = std::max<int_fast32_t>(0, clip.y0 - top);
+        auto const y_to   = std::min<int_fast32_t>(glyph.height, clip.y1 - top);
+        for (auto y = y_from; x_from < x_to and y < y_to; ++y) {
+            auto const * coverage = glyph.data + glyph.stride * y;
+            spl::graphics::over_span(
+                color,
+                std::span{coverage + x_from, coverage + x_to},
+                std::span{img.row_ptr(top + y) + left + x_from, static_cast<size_t>(x_to - x_from)},
+                img.blending()
+            );
         }
-        auto const & [width, height, x_off, y_off, data] = data_it->second;
+    };
 
-        for (int y = 0; y < height; ++y) {
-            for (int x = 0; x < width; ++x) {
-                auto & pixel = img.pixel(
-                    _origin.x + x_pos + x0 + x + x_off,
-                    _origin.y + y0 + y + y_off
+    for (auto const & g : _glyphs) {
+        auto const pen = vertex{origin.x + g.x, origin.y + g.y};
+        if (not clip.intersects({pen.x + g.x0, pen.y + g.y0, pen.x + g.x1, pen.y + g.y1})) {
+            continue;
+        }
+        auto const key = spl::detail::glyph_key{g.codepoint, height_bits, g.shift};
+        if (auto const cached = cache.find(key)) {
+            draw(cached->bitmap, pen);
+            continue;
+        }
+        auto [width, height, x_off, y_off] = std::array{0, 0, 0, 0};
+        auto const data = std::unique_ptr<uint8_t [], detail::stb_deleter>(stbtt_GetCodepointBitmapSubpixel(
+            _font.face_info(),  // info
+            scale, scale,       // scale x, y
+            static_cast<float>(g.shift) / steps, 0,  // shift x, y
+            g.codepoint,        // codepoint (int)
+            &width, &height,    // width, height (out params)
+            &x_off, &y_off      // offset from the top-left corner (out params)
+        ));
+        auto const glyph = spl::detail::glyph_bitmap{data.get(), width, height, width, x_off, y_off};
+        draw(glyph, pen);
+        cache.insert(key, glyph);
+    }
+}
+
+void text_run::_draw_distance_field(viewport img, vertex const origin, rgba const color) const noexcept
+{
+    auto const * const info = _font.face_info();
+    auto const field_scale = stbtt_ScaleForPixelHeight(info, detail::field_height);
+    auto const ratio = _font._height / detail::field_height;
+    // the distance in pixels of the target between two values of the field
+    auto const unit = ratio * static_cast<float>(detail::field_padding) / detail::field_edge;
+    auto const height_bits = std::bit_cast<uint32_t>(detail::field_height);
+    auto const steps = spl::detail::glyph_cache::subpixel_steps;
+    auto const clip  = img.clip_box();
+    auto const mode  = img.blending();
+    auto const reach = static_cast<int_fast32_t>(std::ceil(_outline_width + _glow_radius)) + 1;
+    auto & cache = _font.glyphs();
+    auto coverage = std::vector<uint8_t>{};
+
+    auto const to_coverage = [](float const c) {
+        return static_cast<uint8_t>(std::clamp(c, 0.f, 1.f) * 255.f + 0.5f);
+    };
+    auto const sample = [](spl::detail::glyph_bitmap const & field, float const u, float const v) {
+        auto const fu = std::floor(u);
+        auto const fv = std::floor(v);
+        auto const x  = static_cast<int>(fu);
+        auto const y  = static_cast<int>(fv);
+        auto const at = [&field](int const i, int const j) {
+            auto const inside = 0 <= i and i < field.width and 0 <= j and j < field.height;
+            return inside ? static_cast<float>(field.data[j * field.stride + i]) : 0.f;
+        };
+        auto const tu = u - fu;
+        auto const tv = v - fv;
+        auto const top    = at(x, y) + (at(x + 1, y) - at(x, y)) * tu;
+        auto const bottom = at(x, y + 1) + (at(x + 1, y + 1) - at(x, y + 1)) * tu;
+        return top + (bottom - top) * tv;
+    };
+
+    // every layer is drawn under the next one for the whole run, so that the effects of a glyph
+    // never cover its neighbours
+    enum class layer { glow, outline, fill };
+    auto const draw = [&](
+        spl::detail::glyph_bitmap const & field, float const pen_x, int_fast32_t const pen_y,
+        graphics::bounding_box const area, layer const l
+    ) {
+        auto const left = pen_x + static_cast<float>(field.x_off) * ratio;
+        auto const top  = static_cast<float>(pen_y) + static_cast<float>(field.y_off) * ratio;
+        auto const [x0, y0, x1, y1] = area.intersect(clip);
+        if (x0 >= x1 or y0 >= y1) {
+            return;
+        }
+        auto const [paint, grow] = [&] {
+            switch (l) {
+            case layer::glow:    return std::pair{_glow_color, _outline_width};
+            case layer::outline: return std::pair{_outline_color, _outline_width};
+            case layer::fill:    break;
+            }
+            return std::pair{color, 0.f};
+        }();
+        coverage.resize(static_cast<std::size_t>(x1 - x0));
+        auto const step = 1.f / ratio;
+        auto const u0 = (static_cast<float>(x0) + 0.5f - left) * step - 0.5f;
+        for (auto y = y0; y < y1; ++y) {
+            auto const v = (static_cast<float>(y) + 0.5f - top) * step - 0.5f;
+            for (auto x = x0; x < x1; ++x) {
+                auto const u = u0 + static_cast<float>(x - x0) * step;
+                // positive inside, in pixels of the target
+                auto const distance = (sample(field, u, v) - detail::field_edge) * unit + grow;
+                auto const c = l == layer::glow ? 1.f + distance / _glow_radius : distance + 0.5f;
+                coverage[static_cast<std::size_t>(x - x0)] = to_coverage(l == layer::glow ? c * std::abs(c) : c);
+            }
+            // only the covered runs: blending with no coverage would still round translucent pixels
+            auto * const pixels = img.row_ptr(y) + x0;
+            auto const covered = [](uint8_t const c) { return c != 0; };
+            for (auto from = std::ranges::find_if(coverage, covered); from != coverage.end(); ) {
+                auto const to = std::find(from, coverage.end(), uint8_t{0});
+                spl::graphics::over_span(
+                    paint, std::span<uint8_t const>{from, to},
+                    std::span{pixels + (from - coverage.begin()), static_cast<std::size_t>(to - from)}, mode
                 );
-                pixel = spl::graphics::over(color.blend(data[x + width * y]), pixel);
+                from = std::find_if(to, coverage.end(), covered);
             }
         }
-        x_pos += advance * scale;
-        if (cp_it + 1 != end) {
-            auto next_codepoint = static_cast<uint32_t>(*(cp_it + 1));
-            x_pos += scale * stbtt_GetCodepointKernAdvance(_font.face_info(), codepoint, next_codepoint);
+    };
+
+    auto const draw_layer = [&](layer const l) {
+        auto const margin = [&] {
+            switch (l) {
+            case layer::glow:    return reach;
+            case layer::outline: return static_cast<int_fast32_t>(std::ceil(_outline_width)) + 1;
+            case layer::fill:    break;
+            }
+            return int_fast32_t{1};
+        }();
+        for (auto const & g : _glyphs) {
+            // the field is wider than the glyph, but every layer reaches only so far out of it
+            auto const pen = vertex{origin.x + g.x, origin.y + g.y};
+            auto const area = graphics::bounding_box{
+                pen.x + g.x0 - margin, pen.y + g.y0 - margin, pen.x + g.x1 + margin, pen.y + g.y1 + margin
+            };
+            if (not clip.intersects(area)) {
+                continue;
+            }
+            auto const pen_x = static_cast<float>(pen.x) + static_cast<float>(g.shift) / steps;
+            auto const key = spl::detail::glyph_key{g.codepoint, height_bits, spl::detail::glyph_cache::distance_field};
+            if (auto const cached = cache.find(key)) {
+                draw(cached->bitmap, pen_x, pen.y, area, l);
+                continue;
+            }
+            auto [width, height, x_off, y_off] = std::array{0, 0, 0, 0};
+            auto const data = std::unique_ptr<uint8_t [], detail::stb_deleter>(stbtt_GetCodepointSDF(
+                info, field_scale, g.codepoint,
+                detail::field_padding, static_cast<uint8_t>(detail::field_edge),   // padding, value on the edge
+                detail::field_edge / static_cast<float>(detail::field_padding),  // values per pixel
+                &width, &height, &x_off, &y_off
+            ));
+            if (data == nullptr) {
+                continue;
+            }
+            auto const field = spl::detail::glyph_bitmap{data.get(), width, height, width, x_off, y_off};
+            draw(field, pen_x, pen.y, area, l);
+            cache.insert(key, field);
         }
+    };
+
+    if (_glow_radius > 0.f and _glow_color.a != 0) {
+        draw_layer(layer::glow);
+    }
+    if (_outline_width > 0.f and _outline_color.a != 0) {
+        draw_layer(layer::outline);
     }
+    draw_layer(layer::fill);
 }
 
 } // namespace spl::graphics
@@ -6,6 +6,7 @@
  */
 
 #include "spl/viewport.hpp"
+#include "spl/detail/exceptions.hpp"
 
 namespace spl::graphics
 {
@@ -28,74 +29,99 @@ template <bool Const>
 auto basic_viewport<Const>::pixel_noexcept(index_type const x, index_type const y) noexcept
     -> reference
 {
-    return _base->pixel_noexcept(_x + x, _y + y);
+    if (not _clip.contains(x, y)) {
+        return image::_garbage_pixel;
+    }
+    return pixel_unchecked(x, y);
 }
 
 template <bool Const>
 auto basic_viewport<Const>::pixel_noexcept(index_type const x, index_type const y) const noexcept
     -> const_reference
 {
-    return _base->pixel_noexcept(_x + x, _y + y);
+    if (not _clip.contains(x, y)) {
+        return image::_garbage_pixel;
+    }
+    return pixel_unchecked(x, y);
 }
 
 template <bool Const>
 auto basic_viewport<Const>::row(size_t const y) -> row_view
 {
     auto it = _base->get_pixel_iterator(_x, _y + y);
-    return {it, width()};
+    return {it, width(), static_cast<std::ptrdiff_t>(stride())};
 }
 
 template <bool Const>
 auto basic_viewport<Const>::row(size_t const y) const -> const_row_view
 {
     auto it = std::as_const(*_base).get_pixel_iterator(_x, _y + y);
-    return {it, width()};
+    return {it, width(), static_cast<std::ptrdiff_t>(stride())};
 }
 
 template <bool Const>
 auto basic_viewport<Const>::column(size_t const x) -> column_view
 {
     auto it = _base->get_pixel_iterator(_x + x, _y);
-    return {it, width()};
+    return {{it, stride()}, height()};
 }
 
 template <bool Const>
 auto basic_viewport<Const>::column(size_t const x) const -> const_column_view
 {
     auto it = std::as_const(*_base).get_pixel_iterator(_x + x, _y);
-    static_assert(std::same_as<decltype(it), std::vector<rgba>::const_iterator>);
-    return {it, width()};
+    static_assert(std::same_as<decltype(it), image::const_iterator>);
+    return {{it, stride()}, height()};
 }
 
 template <bool Const>
 auto basic_viewport<Const>::rows() -> row_range
 {
-    return {row(_x), height()};
+    return {row(0), height()};
 }
 
 template <bool Const>
 auto basic_viewport<Const>::rows() const -> const_row_range
 {
-    return {row(_x), height()};
+    return {row(0), height()};
 }
 
 template <bool Const>
 auto basic_viewport<Const>::columns() -> column_range
 {
-    return {column(_y), width()};
+    return {column(0), width()};
 }
 
 template <bool Const>
 auto basic_viewport<Const>::columns() const -> const_column_range
 {
-    return {column(_y), width()};
+    return {column(0), width()};
+}
+
+template <bool Const>
+auto basic_viewport<Const>::blending(blend_mode const mode) & -> basic_viewport &
+{
+    if ((mode == blend_mode::premultiplied) != (_blending == blend_mode::premultiplied)) {
+        throw spl::invalid_argument{"'viewport::blending' cannot switch from or to premultiplied alpha"};
+    }
+    _blending = mode;
+    return *this;
+}
+
+template <bool Const>
+auto basic_viewport<Const>::blending(blend_mode const mode) && -> basic_viewport
+{
+    blending(mode);
+    return std::move(*this);
 }
 
 template <>
 auto basic_viewport<false>::fill(rgba const c) & noexcept -> basic_viewport &
 {
+    auto const value = stored_color(c, _blending);
+    add_damage(_full_box());
     for (auto i : std::views::iota(0, sheight())) {
-        std::ranges::fill(row(i), c);
+        std::ranges::fill(row(i), value);
     }
     return *this;
 }
@@ -103,8 +129,10 @@ auto basic_viewport<false>::fill(rgba const c) & noexcept -> basic_viewport &
 template <>
 auto basic_viewport<false>::fill(rgba const c) && noexcept -> basic_viewport
 {
+    auto const value = stored_color(c, _blending);
+    add_damage(_full_box());
     for (auto i : std::views::iota(0, sheight())) {
-        std::ranges::fill(row(i), c);
+        std::ranges::fill(row(i), value);
     }
     return *this;
 }